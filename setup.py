@@ -33,6 +33,7 @@ if platform.system().startswith('Win'):
         '/O2',
         f'/DVERSION_INFO={__version__}',
     ]
+    common_link_args = []
     arch_avx = ['/arch:AVX2']
     arch_sse = ['/arch:SSE2']
     arch_basic = []
@@ -42,8 +43,10 @@ else:
         '-fno-strict-aliasing',
         '-O3',
         '-g0',
+        '-pthread',
         f'-DVERSION_INFO={__version__}',
     ]
+    common_link_args = ['-pthread']
     arch_avx = ['-mavx2']
     arch_sse = ['-msse2', '-mno-avx2']
     arch_basic = []
@@ -57,6 +60,7 @@ stim_detect_machine_architecture = Extension(
         *common_compile_args,
         *arch_basic,
     ],
+    extra_link_args=common_link_args,
 )
 stim_polyfill = Extension(
     'stim._stim_polyfill',
@@ -68,6 +72,7 @@ stim_polyfill = Extension(
         *arch_basic,
         '-DSTIM_PYBIND11_MODULE_NAME=_stim_polyfill',
     ],
+    extra_link_args=common_link_args,
 )
 stim_sse2 = Extension(
     'stim._stim_sse2',
@@ -79,6 +84,7 @@ stim_sse2 = Extension(
         *arch_sse,
         '-DSTIM_PYBIND11_MODULE_NAME=_stim_sse2',
     ],
+    extra_link_args=common_link_args,
 )
 
 # NOTE: disabled until https://github.com/quantumlib/Stim/issues/432 is fixed
@@ -92,6 +98,7 @@ stim_sse2 = Extension(
 #         *arch_avx,
 #         '-DSTIM_PYBIND11_MODULE_NAME=_stim_avx2',
 #     ],
+#     extra_link_args=common_link_args,
 # )
 
 with open('glue/python/README.md', encoding='UTF-8') as f:
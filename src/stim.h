@@ -50,6 +50,7 @@
 #include "stim/io/measure_record_batch_writer.h"
 #include "stim/io/measure_record_reader.h"
 #include "stim/io/measure_record_writer.h"
+#include "stim/io/memory_mapped_file.h"
 #include "stim/io/raii_file.h"
 #include "stim/io/sparse_shot.h"
 #include "stim/io/stim_data_formats.h"
@@ -81,6 +82,7 @@
 #include "stim/search/sat/wcnf.h"
 #include "stim/search/search.h"
 #include "stim/simulators/dem_sampler.h"
+#include "stim/simulators/dem_sampling_plan.h"
 #include "stim/simulators/error_analyzer.h"
 #include "stim/simulators/error_matcher.h"
 #include "stim/simulators/force_streaming.h"
@@ -101,7 +103,9 @@
 #include "stim/stabilizers/tableau_iter.h"
 #include "stim/stabilizers/tableau_transposed_raii.h"
 #include "stim/util_bot/arg_parse.h"
+#include "stim/util_bot/counter_rng.h"
 #include "stim/util_bot/error_decomp.h"
+#include "stim/util_bot/ordered_pipeline.h"
 #include "stim/util_bot/probability_util.h"
 #include "stim/util_bot/str_util.h"
 #include "stim/util_bot/twiddle.h"
@@ -25,7 +25,16 @@ using namespace stim;
 
 int stim::command_detect(int argc, const char **argv) {
     check_for_unknown_arguments(
-        {"--seed", "--shots", "--append_observables", "--out_format", "--out", "--in", "--obs_out", "--obs_out_format"},
+        {"--seed",
+         "--shots",
+         "--append_observables",
+         "--out_format",
+         "--out",
+         "--in",
+         "--obs_out",
+         "--obs_out_format",
+         "--threads",
+         "--simd_width"},
         {"--detect", "--prepend_observables"},
         "detect",
         argc,
@@ -42,6 +51,8 @@ int stim::command_detect(int argc, const char **argv) {
         find_argument("--shots", argc, argv)    ? (uint64_t)find_int64_argument("--shots", 1, 0, INT64_MAX, argc, argv)
         : find_argument("--detect", argc, argv) ? (uint64_t)find_int64_argument("--detect", 1, 0, INT64_MAX, argc, argv)
                                                 : 1;
+    size_t num_threads = (size_t)find_int64_argument("--threads", 1, 1, 4096, argc, argv);
+    size_t simd_width = choose_bitword_width((size_t)find_int64_argument("--simd_width", 0, 0, 512, argc, argv));
     if (out_format.id == SampleFormat::SAMPLE_FORMAT_DETS && !append_observables) {
         prepend_observables = true;
     }
@@ -65,16 +76,19 @@ int stim::command_detect(int argc, const char **argv) {
     auto circuit = Circuit::from_file(in.f);
     in.done();
     auto rng = optionally_seeded_rng(argc, argv);
-    sample_batch_detection_events_writing_results_to_disk<MAX_BITWORD_WIDTH>(
-        circuit,
-        num_shots,
-        prepend_observables,
-        append_observables,
-        out.f,
-        out_format.id,
-        rng,
-        obs_out.f,
-        obs_out_format.id);
+    with_bitword_width(simd_width, [&]<size_t W>() {
+        sample_batch_detection_events_writing_results_to_disk<W>(
+            circuit,
+            num_shots,
+            prepend_observables,
+            append_observables,
+            out.f,
+            out_format.id,
+            rng,
+            obs_out.f,
+            obs_out_format.id,
+            num_threads);
+    });
     return EXIT_SUCCESS;
 }
 
@@ -196,6 +210,30 @@ SubCommandHelp stim::command_detect_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--threads",
+            "int",
+            "1",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Specifies the number of threads to use when sampling.
+
+            Defaults to 1.
+            Must be an integer between 1 and 4096.
+
+            When more than one thread is used, shots are simulated in
+            independent batches. Each batch draws its randomness from its own
+            stream, derived from the seed and the batch's index, and batches are
+            written out in order. As a result, using `--seed` with more than one
+            thread still gives deterministic results, but they will differ from
+            the results produced when using a single thread.
+
+            Circuits so large that they require streaming their results ignore
+            this flag and run on a single thread.
+        )PARAGRAPH"),
+        });
+
     result.flags.push_back(
         SubCommandHelpFlag{
             "--shots",
@@ -322,5 +360,22 @@ SubCommandHelp stim::command_detect_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--simd_width",
+            "int",
+            "[best available]",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Overrides the SIMD word width, in bits, used by the simulator.
+
+            By default, the widest width that stim was compiled with and that
+            the running machine's cpu supports is used. Must be one of 64, 128,
+            256, or 512, and must be compiled in and supported by the cpu.
+
+            This flag is intended for benchmarking and debugging. Results
+            sampled with `--seed` can depend on the width.
+        )PARAGRAPH"),
+        });
     return result;
 }
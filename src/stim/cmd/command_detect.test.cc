@@ -15,6 +15,7 @@
 #include "gtest/gtest.h"
 
 #include "stim/main_namespaced.test.h"
+#include "stim/mem/simd_word.h"
 
 using namespace stim;
 
@@ -232,3 +233,75 @@ TEST(command_detect, seeded_detecting) {
                 DETECTOR rec[-1]
             )input"));
 }
+
+TEST(command_detect, threaded_detecting) {
+    auto circuit = R"input(
+        X_ERROR(0.25) 0 1
+        M 0 1
+        DETECTOR rec[-1]
+        DETECTOR rec[-2]
+        OBSERVABLE_INCLUDE(0) rec[-1]
+    )input";
+
+    auto a = run_captured_stim_main({"detect", "--shots=5000", "--seed=5", "--threads=3", "--out_format=dets"}, circuit);
+    auto b = run_captured_stim_main({"detect", "--shots=5000", "--seed=5", "--threads=3", "--out_format=dets"}, circuit);
+    auto c = run_captured_stim_main({"detect", "--shots=5000", "--seed=5", "--threads=4", "--out_format=dets"}, circuit);
+    auto d = run_captured_stim_main({"detect", "--shots=5000", "--seed=6", "--threads=3", "--out_format=dets"}, circuit);
+    ASSERT_EQ(a, b);
+    ASSERT_EQ(a, c);
+    ASSERT_NE(a, d);
+
+    size_t num_lines = 0;
+    size_t num_d0 = 0;
+    for (char c : a) {
+        num_lines += c == '\n';
+    }
+    for (size_t k = 0; (k = a.find("D0", k)) != std::string::npos; k++) {
+        num_d0++;
+    }
+    ASSERT_EQ(num_lines, 5000);
+    ASSERT_TRUE(1000 < num_d0 && num_d0 < 1500) << num_d0;
+
+    ASSERT_EQ(
+        trim(run_captured_stim_main({"detect", "--shots=3", "--threads=2", "--append_observables"}, R"input(
+            X_ERROR(1) 0
+            M 0 1
+            DETECTOR rec[-1]
+            DETECTOR rec[-2]
+            OBSERVABLE_INCLUDE(0) rec[-2]
+        )input")),
+        trim(R"output(
+011
+011
+011
+        )output"));
+
+    // More threads than batches doesn't allocate more simulators than batches.
+    ASSERT_EQ(
+        trim(run_captured_stim_main({"detect", "--shots=1", "--threads=4096"}, R"input(
+            X_ERROR(1) 0
+            M 0
+            DETECTOR rec[-1]
+        )input")),
+        "1");
+}
+
+TEST(command_detect, simd_width) {
+    std::string expected;
+    for (size_t k = 0; k < 300; k++) {
+        expected += "01\n";
+    }
+    for (size_t w = 64; w <= choose_bitword_width(); w *= 2) {
+        std::string flag = "--simd_width=" + std::to_string(w);
+        ASSERT_EQ(run_captured_stim_main({"detect", "--shots=300", flag.c_str()}, R"input(
+                X_ERROR(1) 0
+                M 0 1
+                DETECTOR rec[-1]
+                DETECTOR rec[-2]
+            )input"),
+            expected);
+    }
+
+    ASSERT_TRUE(matches(
+        run_captured_stim_main({"detect", "--simd_width=96"}, "M 0"), ".*isn't compiled into this binary.*"));
+}
@@ -23,6 +23,8 @@ int stim::command_m2d(int argc, const char **argv) {
             "--obs_out",
             "--obs_out_format",
             "--ran_without_feedback",
+            "--simd_width",
+            "--threads",
         },
         {
             "--m2d",
@@ -37,6 +39,8 @@ int stim::command_m2d(int argc, const char **argv) {
     bool append_observables = find_bool_argument("--append_observables", argc, argv);
     bool skip_reference_sample = find_bool_argument("--skip_reference_sample", argc, argv);
     bool ran_without_feedback = find_bool_argument("--ran_without_feedback", argc, argv);
+    size_t num_threads = (size_t)find_int64_argument("--threads", 1, 1, 4096, argc, argv);
+    size_t simd_width = choose_bitword_width((size_t)find_int64_argument("--simd_width", 0, 0, 512, argc, argv));
     FILE *circuit_file = find_open_file_argument("--circuit", nullptr, "rb", argc, argv);
     auto circuit = Circuit::from_file(circuit_file);
     fclose(circuit_file);
@@ -55,18 +59,21 @@ int stim::command_m2d(int argc, const char **argv) {
         obs_out = nullptr;
     }
 
-    stream_measurements_to_detection_events<MAX_BITWORD_WIDTH>(
-        in,
-        in_format.id,
-        sweep_in,
-        sweep_format.id,
-        out,
-        out_format.id,
-        circuit,
-        append_observables,
-        skip_reference_sample,
-        obs_out,
-        obs_out_format.id);
+    with_bitword_width(simd_width, [&]<size_t W>() {
+        stream_measurements_to_detection_events<W>(
+            in,
+            in_format.id,
+            sweep_in,
+            sweep_format.id,
+            out,
+            out_format.id,
+            circuit,
+            append_observables,
+            skip_reference_sample,
+            obs_out,
+            obs_out_format.id,
+            num_threads);
+    });
     if (in != stdin) {
         fclose(in);
     }
@@ -397,5 +404,41 @@ SubCommandHelp stim::command_m2d_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--threads",
+            "int",
+            "1",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Specifies the number of threads to use when converting.
+
+            Defaults to 1.
+            Must be an integer between 1 and 4096.
+
+            The measurement data is read and the detection event data is
+            written on the main thread, in order, while batches of shots are
+            converted concurrently by the worker threads. The output doesn't
+            depend on the number of threads.
+        )PARAGRAPH"),
+        });
+
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--simd_width",
+            "int",
+            "[best available]",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Overrides the SIMD word width, in bits, used by the simulator.
+
+            By default, the widest width that stim was compiled with and that
+            the running machine's cpu supports is used. Must be one of 64, 128,
+            256, or 512, and must be compiled in and supported by the cpu.
+
+            This flag is intended for benchmarking and debugging. Results
+            sampled with `--seed` can depend on the width.
+        )PARAGRAPH"),
+        });
     return result;
 }
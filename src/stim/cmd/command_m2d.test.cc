@@ -61,6 +61,34 @@ shot D0 D1
             )output"));
 }
 
+TEST(command_m2d, m2d_threads) {
+    RaiiTempNamedFile tmp(R"CIRCUIT(
+        X 0
+        M 0 1
+        DETECTOR rec[-2]
+        DETECTOR rec[-1]
+        OBSERVABLE_INCLUDE(2) rec[-1]
+    )CIRCUIT");
+    std::string input;
+    std::string expected;
+    for (size_t k = 0; k < 3000; k++) {
+        input += k % 3 ? "01\n" : "10\n";
+        expected += k % 3 ? "shot D0 D1 L2\n" : "shot\n";
+    }
+
+    ASSERT_EQ(
+        run_captured_stim_main(
+            {"m2d",
+             "--in_format=01",
+             "--out_format=dets",
+             "--circuit",
+             tmp.path.c_str(),
+             "--append_observables",
+             "--threads=3"},
+            input),
+        expected);
+}
+
 TEST(command_m2d, m2d_without_feedback) {
     RaiiTempNamedFile tmp(R"CIRCUIT(
         CX 0 2 1 2
@@ -26,7 +26,7 @@ using namespace stim;
 
 int stim::command_sample(int argc, const char **argv) {
     check_for_unknown_arguments(
-        {"--seed", "--skip_reference_sample", "--out_format", "--out", "--in", "--shots"},
+        {"--seed", "--skip_reference_sample", "--out_format", "--out", "--in", "--shots", "--simd_width"},
         {"--sample", "--frame0"},
         "sample",
         argc,
@@ -37,6 +37,7 @@ int stim::command_sample(int argc, const char **argv) {
         find_argument("--shots", argc, argv)    ? (uint64_t)find_int64_argument("--shots", 1, 0, INT64_MAX, argc, argv)
         : find_argument("--sample", argc, argv) ? (uint64_t)find_int64_argument("--sample", 1, 0, INT64_MAX, argc, argv)
                                                 : 1;
+    size_t simd_width = choose_bitword_width((size_t)find_int64_argument("--simd_width", 0, 0, 512, argc, argv));
     if (num_shots == 0) {
         return EXIT_SUCCESS;
     }
@@ -49,17 +50,19 @@ int stim::command_sample(int argc, const char **argv) {
         skip_reference_sample = true;
     }
 
-    if (num_shots == 1 && !skip_reference_sample) {
-        TableauSimulator<MAX_BITWORD_WIDTH>::sample_stream(in, out, out_format.id, false, rng);
-    } else {
-        assert(num_shots > 0);
-        auto circuit = Circuit::from_file(in);
-        simd_bits<MAX_BITWORD_WIDTH> ref(0);
-        if (!skip_reference_sample) {
-            ref = TableauSimulator<MAX_BITWORD_WIDTH>::reference_sample_circuit(circuit);
+    with_bitword_width(simd_width, [&]<size_t W>() {
+        if (num_shots == 1 && !skip_reference_sample) {
+            TableauSimulator<W>::sample_stream(in, out, out_format.id, false, rng);
+        } else {
+            assert(num_shots > 0);
+            auto circuit = Circuit::from_file(in);
+            simd_bits<W> ref(0);
+            if (!skip_reference_sample) {
+                ref = TableauSimulator<W>::reference_sample_circuit(circuit);
+            }
+            sample_batch_measurements_writing_results_to_disk(circuit, ref, num_shots, out, out_format.id, rng);
         }
-        sample_batch_measurements_writing_results_to_disk(circuit, ref, num_shots, out, out_format.id, rng);
-    }
+    });
 
     if (in != stdin) {
         fclose(in);
@@ -243,5 +246,22 @@ SubCommandHelp stim::command_sample_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--simd_width",
+            "int",
+            "[best available]",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Overrides the SIMD word width, in bits, used by the simulator.
+
+            By default, the widest width that stim was compiled with and that
+            the running machine's cpu supports is used. Must be one of 64, 128,
+            256, or 512, and must be compiled in and supported by the cpu.
+
+            This flag is intended for benchmarking and debugging. Results
+            sampled with `--seed` can depend on the width.
+        )PARAGRAPH"),
+        });
     return result;
 }
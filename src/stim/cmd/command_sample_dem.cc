@@ -36,6 +36,9 @@ int stim::command_sample_dem(int argc, const char **argv) {
             "--err_out_format",
             "--replay_err_in",
             "--replay_err_in_format",
+            "--threads",
+            "--sparse",
+            "--simd_width",
         },
         {},
         "sample_dem",
@@ -47,6 +50,9 @@ int stim::command_sample_dem(int argc, const char **argv) {
     const auto &err_in_format =
         find_enum_argument("--replay_err_in_format", "01", format_name_to_enum_map(), argc, argv);
     uint64_t num_shots = find_int64_argument("--shots", 1, 0, INT64_MAX, argc, argv);
+    size_t num_threads = (size_t)find_int64_argument("--threads", 1, 1, 4096, argc, argv);
+    bool sparse = find_bool_argument("--sparse", argc, argv);
+    size_t simd_width = choose_bitword_width((size_t)find_int64_argument("--simd_width", 0, 0, 512, argc, argv));
 
     RaiiFile in(find_open_file_argument("--in", stdin, "rb", argc, argv));
     RaiiFile out(find_open_file_argument("--out", stdout, "wb", argc, argv));
@@ -68,6 +74,12 @@ int stim::command_sample_dem(int argc, const char **argv) {
     if (in.f == stdin) {
         out.responsible_for_closing = false;
     }
+    if (sparse && err_in.f != nullptr) {
+        throw std::invalid_argument("--sparse can't be combined with --replay_err_in.");
+    }
+    if (sparse && num_threads > 1) {
+        throw std::invalid_argument("--sparse can't be combined with --threads.");
+    }
     if (num_shots == 0) {
         return EXIT_SUCCESS;
     }
@@ -75,17 +87,26 @@ int stim::command_sample_dem(int argc, const char **argv) {
     auto dem = DetectorErrorModel::from_file(in.f);
     in.done();
 
-    DemSampler<MAX_BITWORD_WIDTH> sampler(std::move(dem), optionally_seeded_rng(argc, argv), 1024);
-    sampler.sample_write(
-        num_shots,
-        out.f,
-        out_format.id,
-        obs_out.f,
-        obs_out_format.id,
-        err_out.f,
-        err_out_format.id,
-        err_in.f,
-        err_in_format.id);
+    with_bitword_width(simd_width, [&]<size_t W>() {
+        // Sparse sampling doesn't use the dense buffers, so don't allocate them.
+        DemSampler<W> sampler(std::move(dem), optionally_seeded_rng(argc, argv), sparse ? 0 : 1024);
+        if (sparse) {
+            sampler.sample_write_sparse(
+                num_shots, out.f, out_format.id, obs_out.f, obs_out_format.id, err_out.f, err_out_format.id);
+            return;
+        }
+        sampler.sample_write(
+            num_shots,
+            out.f,
+            out_format.id,
+            obs_out.f,
+            obs_out_format.id,
+            err_out.f,
+            err_out_format.id,
+            err_in.f,
+            err_in_format.id,
+            num_threads);
+    });
 
     return EXIT_SUCCESS;
 }
@@ -345,6 +366,50 @@ SubCommandHelp stim::command_sample_dem_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--sparse",
+            "bool",
+            "false",
+            {"[none]", "[switch]"},
+            clean_doc_string(R"PARAGRAPH(
+            Samples one shot at a time, without materializing dense buffers.
+
+            By default, shots are sampled in large batches that store one bit
+            for every (detector, shot) pair and every (error, shot) pair. When
+            `--sparse` is specified, each shot is instead sampled by skipping
+            directly to the errors that occur, and only the resulting events
+            are stored. This uses memory proportional to the number of events
+            in a shot, and is much faster for large models with low error
+            rates, especially when writing sparse formats like `dets` or `hits`.
+
+            Can't be combined with `--replay_err_in`, `--threads`, or the
+            `ptb64` format. Using `--seed` with `--sparse` gives deterministic
+            results, but they will differ from the results produced without it.
+        )PARAGRAPH"),
+        });
+
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--threads",
+            "int",
+            "1",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Specifies the number of threads to use when sampling.
+
+            Defaults to 1.
+            Must be an integer between 1 and 4096.
+
+            When more than one thread is used, shots are sampled in independent
+            blocks. Each block draws its randomness from its own stream, derived
+            from the seed and the block's index, and blocks are written out in
+            order. As a result, using `--seed` with more than one thread still
+            gives deterministic results, but they will differ from the results
+            produced when using a single thread.
+        )PARAGRAPH"),
+        });
+
     result.flags.push_back(
         SubCommandHelpFlag{
             "--in",
@@ -380,5 +445,22 @@ SubCommandHelp stim::command_sample_dem_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--simd_width",
+            "int",
+            "[best available]",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Overrides the SIMD word width, in bits, used by the simulator.
+
+            By default, the widest width that stim was compiled with and that
+            the running machine's cpu supports is used. Must be one of 64, 128,
+            256, or 512, and must be compiled in and supported by the cpu.
+
+            This flag is intended for benchmarking and debugging. Results
+            sampled with `--seed` can depend on the width.
+        )PARAGRAPH"),
+        });
     return result;
 }
@@ -52,3 +52,48 @@ TEST(main, sample_dem) {
             )output"));
     ASSERT_EQ(obs_out.read_contents(), "001\n001\n001\n001\n001\n");
 }
+
+TEST(main, sample_dem_threads) {
+    auto dem = R"input(
+        error(0.25) D0
+        error(0.125) D1 L0
+    )input";
+    auto a = run_captured_stim_main({"sample_dem", "--shots=5000", "--seed=5", "--threads=2"}, dem);
+    ASSERT_EQ(a, run_captured_stim_main({"sample_dem", "--shots=5000", "--seed=5", "--threads=2"}, dem));
+    ASSERT_EQ(a, run_captured_stim_main({"sample_dem", "--shots=5000", "--seed=5", "--threads=5"}, dem));
+    ASSERT_NE(a, run_captured_stim_main({"sample_dem", "--shots=5000", "--seed=6", "--threads=2"}, dem));
+    ASSERT_EQ(a.size(), 5000 * 3);
+
+    ASSERT_EQ(
+        trim(run_captured_stim_main({"sample_dem", "--shots=3", "--threads=4"}, R"input(
+            error(1) D1
+        )input")),
+        trim(R"output(
+01
+01
+01
+        )output"));
+}
+
+TEST(main, sample_dem_sparse) {
+    ASSERT_EQ(
+        trim(run_captured_stim_main({"sample_dem", "--shots=3", "--sparse", "--out_format=dets"}, R"input(
+            error(0) D0
+            error(1) D1 D2 L0
+            error(1) D2 D4
+        )input")),
+        trim(R"output(
+shot D1 D4
+shot D1 D4
+shot D1 D4
+        )output"));
+
+    auto dem = R"input(
+        error(0.01) D0 D1
+        error(0.02) D1 L0
+    )input";
+    auto a = run_captured_stim_main({"sample_dem", "--shots=1000", "--seed=5", "--sparse"}, dem);
+    ASSERT_EQ(a, run_captured_stim_main({"sample_dem", "--shots=1000", "--seed=5", "--sparse"}, dem));
+    ASSERT_NE(a, run_captured_stim_main({"sample_dem", "--shots=1000", "--seed=6", "--sparse"}, dem));
+    ASSERT_EQ(a.size(), 1000 * 3);
+}
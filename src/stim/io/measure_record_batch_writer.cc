@@ -20,8 +20,8 @@
 
 using namespace stim;
 
-MeasureRecordBatchWriter::MeasureRecordBatchWriter(FILE *out, size_t num_shots, SampleFormat output_format)
-    : output_format(output_format), out(out) {
+MeasureRecordBatchWriter::MeasureRecordBatchWriter(FILE *out, size_t num_shots, SampleFormat output_format, bool async)
+    : output_format(output_format), out(out), async(async), worker_busy(false), stopping(false) {
     if (num_shots > 768) {
         throw std::out_of_range("num_shots > 768 (safety check to ensure staying away from linux file handle limit)");
     }
@@ -46,25 +46,103 @@ MeasureRecordBatchWriter::MeasureRecordBatchWriter(FILE *out, size_t num_shots,
         writers.push_back(MeasureRecordWriter::make(file, f));
         temporary_files.push_back(file);
     }
+    if (async) {
+        worker = std::thread([this]() {
+            worker_loop();
+        });
+    }
 }
 
 MeasureRecordBatchWriter::~MeasureRecordBatchWriter() {
+    if (worker.joinable()) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopping = true;
+            pending.clear();
+        }
+        changed.notify_all();
+        worker.join();
+    }
     for (auto &e : temporary_files) {
         fclose(e);
     }
     temporary_files.clear();
 }
 
-void MeasureRecordBatchWriter::begin_result_type(char result_type) {
-    for (auto &e : writers) {
-        e->begin_result_type(result_type);
+void MeasureRecordBatchWriter::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        changed.wait(lock, [&]() {
+            return stopping || !pending.empty();
+        });
+        if (stopping) {
+            return;
+        }
+        auto task = std::move(pending.front());
+        pending.pop_front();
+        worker_busy = true;
+        lock.unlock();
+        changed.notify_all();
+        std::exception_ptr err;
+        try {
+            task();
+        } catch (...) {
+            err = std::current_exception();
+        }
+        lock.lock();
+        worker_busy = false;
+        if (err && !failure) {
+            failure = err;
+        }
+        changed.notify_all();
     }
 }
 
-void MeasureRecordBatchWriter::write_end() {
-    for (auto &writer : writers) {
-        writer->write_end();
+void MeasureRecordBatchWriter::run(std::function<void()> task) {
+    if (!async) {
+        task();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() {
+        return failure || pending.size() < MAX_PENDING_BATCHES;
+    });
+    if (failure) {
+        std::rethrow_exception(failure);
     }
+    pending.push_back(std::move(task));
+    lock.unlock();
+    changed.notify_all();
+}
+
+void MeasureRecordBatchWriter::wait_until_idle() {
+    if (!async) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() {
+        return failure || (pending.empty() && !worker_busy);
+    });
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+void MeasureRecordBatchWriter::begin_result_type(char result_type) {
+    run([this, result_type]() {
+        for (auto &e : writers) {
+            e->begin_result_type(result_type);
+        }
+    });
+}
+
+void MeasureRecordBatchWriter::write_end() {
+    run([this]() {
+        for (auto &writer : writers) {
+            writer->write_end();
+        }
+    });
+    wait_until_idle();
 
     for (FILE *file : temporary_files) {
         rewind(file);
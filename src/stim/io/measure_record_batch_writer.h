@@ -17,12 +17,25 @@
 #ifndef _STIM_IO_MEASURE_RECORD_BATCH_WRITER_H
 #define _STIM_IO_MEASURE_RECORD_BATCH_WRITER_H
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
 #include "stim/io/measure_record_writer.h"
 #include "stim/mem/simd_bit_table.h"
 
 namespace stim {
 
 /// Handles buffering and writing multiple measurement data streams that ultimately need to be concatenated.
+///
+/// When created in async mode, the data handed to the `batch_write_*` methods is copied and then transposed,
+/// formatted, and written by a background thread. This lets the caller (e.g. a frame simulator streaming its results
+/// to disk) move on to simulating the next batch while the previous one is being written. The background thread
+/// handles the batches in the order they were given, so the output is identical to what the synchronous mode
+/// produces.
 struct MeasureRecordBatchWriter {
     SampleFormat output_format;
     FILE *out;
@@ -32,8 +45,14 @@ struct MeasureRecordBatchWriter {
     /// The first writer will go directly to `out`, whereas the others go into temporary files.
     std::vector<std::unique_ptr<MeasureRecordWriter>> writers;
 
-    MeasureRecordBatchWriter(FILE *out, size_t num_shots, SampleFormat output_format);
-    /// Cleans up temporary files.
+    /// Args:
+    ///     out: Where the concatenated results are written.
+    ///     num_shots: The number of measurement data streams.
+    ///     output_format: The format to write the results in.
+    ///     async: When true, the writing is done by a background thread. At most MAX_PENDING_BATCHES copied batches
+    ///         are held while waiting for that thread; beyond that the caller blocks until one has been written.
+    MeasureRecordBatchWriter(FILE *out, size_t num_shots, SampleFormat output_format, bool async = false);
+    /// Stops the background thread (if any) and cleans up temporary files.
     ~MeasureRecordBatchWriter();
     /// See MeasureRecordWriter::begin_result_type.
     void begin_result_type(char result_type);
@@ -44,17 +63,12 @@ struct MeasureRecordBatchWriter {
     ///     bits: The measurement results. The bit at offset k is the bit for the writer at offset k.
     template <size_t W>
     void batch_write_bit(simd_bits_range_ref<W> bits) {
-        if (output_format == SampleFormat::SAMPLE_FORMAT_PTB64) {
-            uint8_t *p = bits.u8;
-            for (auto &writer : writers) {
-                uint8_t *n = p + 8;
-                writer->write_bytes({p, n});
-                p = n;
-            }
+        if (async) {
+            run([this, copy = simd_bits<W>(bits)]() mutable {
+                write_bit_now<W>(copy);
+            });
         } else {
-            for (size_t k = 0; k < writers.size(); k++) {
-                writers[k]->write_bit(bits[k]);
-            }
+            write_bit_now<W>(bits);
         }
     }
 
@@ -71,6 +85,55 @@ struct MeasureRecordBatchWriter {
     ///         results is required to be a multiple of 64 for performance reasons.
     template <size_t W>
     void batch_write_bytes(const simd_bit_table<W> &table, size_t num_major_u64) {
+        if (async) {
+            run([this, copy = table, num_major_u64]() mutable {
+                write_bytes_now<W>(copy, num_major_u64);
+            });
+        } else {
+            write_bytes_now<W>(table, num_major_u64);
+        }
+    }
+
+    /// Tells each writer to finish up, then concatenates all of their data into the `out` stream and cleans up.
+    void write_end();
+
+   private:
+    /// The number of batches that can be waiting for the background thread before the caller is made to wait.
+    static constexpr size_t MAX_PENDING_BATCHES = 2;
+
+    bool async;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::function<void()>> pending;
+    bool worker_busy;
+    bool stopping;
+    std::exception_ptr failure;
+
+    /// Runs the task immediately, or queues it for the background thread when in async mode.
+    void run(std::function<void()> task);
+    /// Blocks until the background thread has finished all queued tasks, rethrowing any failure it hit.
+    void wait_until_idle();
+    void worker_loop();
+
+    template <size_t W>
+    void write_bit_now(simd_bits_range_ref<W> bits) {
+        if (output_format == SampleFormat::SAMPLE_FORMAT_PTB64) {
+            uint8_t *p = bits.u8;
+            for (auto &writer : writers) {
+                uint8_t *n = p + 8;
+                writer->write_bytes({p, n});
+                p = n;
+            }
+        } else {
+            for (size_t k = 0; k < writers.size(); k++) {
+                writers[k]->write_bit(bits[k]);
+            }
+        }
+    }
+
+    template <size_t W>
+    void write_bytes_now(const simd_bit_table<W> &table, size_t num_major_u64) {
         if (output_format == SampleFormat::SAMPLE_FORMAT_PTB64) {
             for (size_t k = 0; k < writers.size(); k++) {
                 for (size_t w = 0; w < num_major_u64; w++) {
@@ -86,9 +149,6 @@ struct MeasureRecordBatchWriter {
             }
         }
     }
-
-    /// Tells each writer to finish up, then concatenates all of their data into the `out` stream and cleans up.
-    void write_end();
 };
 
 }  // namespace stim
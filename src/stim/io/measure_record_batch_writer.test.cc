@@ -18,6 +18,7 @@
 
 #include "gtest/gtest.h"
 
+#include "stim/io/stim_data_formats.h"
 #include "stim/mem/simd_word.test.h"
 #include "stim/util_bot/test_util.test.h"
 
@@ -42,3 +43,48 @@ TEST_EACH_WORD_SIZE_W(MeasureRecordBatchWriter, basic_usage, {
     ASSERT_EQ(getc(tmp), '0');
     ASSERT_EQ(getc(tmp), '\n');
 })
+
+template <size_t W>
+std::string write_mixed_batches(SampleFormat format, bool async) {
+    std::mt19937_64 rng(5);
+    FILE *tmp = tmpfile();
+    {
+        MeasureRecordBatchWriter w(tmp, 128, format, async);
+        w.begin_result_type('D');
+        for (size_t k = 0; k < 10; k++) {
+            auto table = simd_bit_table<W>::random(128, 128, rng);
+            w.batch_write_bytes<W>(table, 2);
+        }
+        for (size_t k = 0; k < 5; k++) {
+            w.batch_write_bit<W>(simd_bits<W>::random(128, rng));
+        }
+        w.begin_result_type('L');
+        for (size_t k = 0; k < 3; k++) {
+            w.batch_write_bit<W>(simd_bits<W>::random(128, rng));
+        }
+        w.write_end();
+    }
+    return rewind_read_close(tmp);
+}
+
+TEST_EACH_WORD_SIZE_W(MeasureRecordBatchWriter, async_output_matches_sync_output, {
+    for (const auto &kv : format_name_to_enum_map()) {
+        SampleFormat format = kv.second.id;
+        auto expected = write_mixed_batches<W>(format, false);
+        auto actual = write_mixed_batches<W>(format, true);
+        ASSERT_FALSE(expected.empty()) << kv.first;
+        ASSERT_EQ(actual, expected) << kv.first;
+    }
+})
+
+TEST_EACH_WORD_SIZE_W(MeasureRecordBatchWriter, async_destroyed_without_write_end, {
+    FILE *tmp = tmpfile();
+    {
+        MeasureRecordBatchWriter w(tmp, 5, SampleFormat::SAMPLE_FORMAT_01, true);
+        simd_bit_table<W> table(256, 5);
+        for (size_t k = 0; k < 10; k++) {
+            w.batch_write_bytes<W>(table, 4);
+        }
+    }
+    fclose(tmp);
+})
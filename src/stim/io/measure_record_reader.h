@@ -19,6 +19,7 @@
 
 #include <memory>
 
+#include "stim/io/memory_mapped_file.h"
 #include "stim/io/sparse_shot.h"
 #include "stim/io/stim_data_formats.h"
 #include "stim/mem/simd_bit_table.h"
@@ -177,6 +178,8 @@ struct MeasureRecordReader {
 template <size_t W>
 struct MeasureRecordReaderFormatPTB64 : MeasureRecordReader<W> {
     FILE *in;
+    // When the input is a regular file, bulk reads copy straight out of this mapping.
+    MemoryMappedFile mapped;
     // This buffer stores partially transposed shots.
     // The uint64_t for index k of shot s is stored in the buffer at offset k*64 + s.
     simd_bits<W> buf;
@@ -213,6 +216,8 @@ struct MeasureRecordReaderFormat01 : MeasureRecordReader<W> {
 template <size_t W>
 struct MeasureRecordReaderFormatB8 : MeasureRecordReader<W> {
     FILE *in;
+    // When the input is a regular file, bulk reads transpose straight out of this mapping.
+    MemoryMappedFile mapped;
 
     MeasureRecordReaderFormatB8(FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables);
 
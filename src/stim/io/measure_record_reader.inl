@@ -15,6 +15,7 @@
  */
 
 #include <algorithm>
+#include <cstring>
 
 #include "stim/io/measure_record_reader.h"
 
@@ -29,6 +30,12 @@ template <size_t W>
 size_t MeasureRecordReader<W>::read_records_into(
     simd_bit_table<W> &out, bool major_index_is_shot_index, size_t max_shots) {
     if (!major_index_is_shot_index) {
+        max_shots = std::min(max_shots, out.num_minor_bits_padded());
+        if (max_shots % 64 == 0) {
+            // Let the format read directly into the transposed layout, instead of transposing afterwards.
+            out.clear();
+            return read_into_table_with_minor_shot_index(out, max_shots);
+        }
         simd_bit_table<W> buf(out.num_minor_bits_padded(), out.num_major_bits_padded());
         size_t r = read_records_into(buf, true, max_shots);
         buf.transpose_into(out);
@@ -212,7 +219,7 @@ bool MeasureRecordReaderFormat01<W>::start_and_read_entire_record_helper(SAW0 sa
 template <size_t W>
 MeasureRecordReaderFormatB8<W>::MeasureRecordReaderFormatB8(
     FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables)
-    : MeasureRecordReader<W>(num_measurements, num_detectors, num_observables), in(in) {
+    : MeasureRecordReader<W>(num_measurements, num_detectors, num_observables), in(in), mapped(in) {
 }
 
 template <size_t W>
@@ -240,7 +247,39 @@ size_t MeasureRecordReaderFormatB8<W>::read_into_table_with_minor_shot_index(
     if (n == 0) {
         return 0;  // Ambiguous when the data ends. Stop as early as possible.
     }
-    for (size_t read_shots = 0; read_shots < max_shots; read_shots++) {
+
+    // Transpose whole records straight out of the mapped file, when possible.
+    size_t read_shots = 0;
+    long pos = mapped.is_mapped() ? ftell(in) : -1;
+    if (pos >= 0 && (size_t)pos < mapped.size) {
+        size_t nb = (n + 7) >> 3;
+        read_shots = std::min(max_shots, (mapped.size - (size_t)pos) / nb);
+        const uint8_t *records = mapped.data + pos;
+        uint64_t block[64];
+        for (size_t s0 = 0; s0 < read_shots; s0 += 64) {
+            size_t block_shots = std::min<size_t>(64, read_shots - s0);
+            for (size_t byte0 = 0; byte0 < nb; byte0 += 8) {
+                size_t block_bytes = std::min<size_t>(8, nb - byte0);
+                for (size_t s = 0; s < 64; s++) {
+                    block[s] = 0;
+                    if (s < block_shots) {
+                        memcpy(&block[s], records + (s0 + s) * nb + byte0, block_bytes);
+                    }
+                }
+                inplace_transpose_64x64(block, 1);
+                size_t bit0 = byte0 << 3;
+                for (size_t b = 0; b < 64 && bit0 + b < n; b++) {
+                    out_table[bit0 + b].u64[s0 >> 6] = block[b];
+                }
+            }
+        }
+        if (fseek(in, pos + (long)(read_shots * nb), SEEK_SET) != 0) {
+            throw std::invalid_argument("Failed to seek past b8 data read from the memory mapped file.");
+        }
+    }
+
+    // Read anything that wasn't mapped (e.g. data from a pipe) through the FILE*.
+    for (; read_shots < max_shots; read_shots++) {
         for (size_t bit = 0; bit < n; bit += 8) {
             int c = getc(in);
             if (c == EOF) {
@@ -598,6 +637,7 @@ MeasureRecordReaderFormatPTB64<W>::MeasureRecordReaderFormatPTB64(
     FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables)
     : MeasureRecordReader<W>(num_measurements, num_detectors, num_observables),
       in(in),
+      mapped(in),
       buf(0),
       num_unread_shots_in_buf(0) {
 }
@@ -705,7 +745,27 @@ size_t MeasureRecordReaderFormatPTB64<W>::read_into_table_with_minor_shot_index(
     if (max_shots % 64 != 0) {
         throw std::invalid_argument("max_shots must be a multiple of 64 when using PTB64 format");
     }
-    for (size_t shots_read = 0; shots_read < max_shots; shots_read += 64) {
+
+    // The data is already in the transposed layout, so copy it straight out of the mapped file when possible.
+    size_t shots_read = 0;
+    long pos = mapped.is_mapped() ? ftell(in) : -1;
+    if (pos >= 0 && (size_t)pos < mapped.size) {
+        size_t group_bytes = n * sizeof(uint64_t);
+        size_t num_groups = std::min(max_shots >> 6, (mapped.size - (size_t)pos) / group_bytes);
+        const uint8_t *groups = mapped.data + pos;
+        for (size_t g = 0; g < num_groups; g++) {
+            for (size_t bit = 0; bit < n; bit++) {
+                memcpy(&out_table[bit].u64[g], groups + g * group_bytes + bit * sizeof(uint64_t), sizeof(uint64_t));
+            }
+        }
+        shots_read = num_groups << 6;
+        if (fseek(in, pos + (long)(num_groups * group_bytes), SEEK_SET) != 0) {
+            throw std::invalid_argument("Failed to seek past ptb64 data read from the memory mapped file.");
+        }
+    }
+
+    // Read anything that wasn't mapped (e.g. data from a pipe) through the FILE*.
+    for (; shots_read < max_shots; shots_read += 64) {
         for (size_t bit = 0; bit < n; bit++) {
             size_t read = fread(&out_table[bit].u64[shots_read >> 6], 1, sizeof(uint64_t), in);
             if (read != sizeof(uint64_t)) {
@@ -766,6 +766,75 @@ TEST_EACH_WORD_SIZE_W(MeasureRecordReader, read_file_data_into_shot_table_vs_wri
     }
 })
 
+TEST_EACH_WORD_SIZE_W(MeasureRecordReader, read_minor_shot_index_b8_and_ptb64_mixed_with_record_reads, {
+    auto rng = INDEPENDENT_TEST_RNG();
+    for (SampleFormat format : {SampleFormat::SAMPLE_FORMAT_B8, SampleFormat::SAMPLE_FORMAT_PTB64}) {
+        size_t num_shots = 64 * 7;
+        size_t bits_per_shot = 70;
+        simd_bit_table<W> expected(num_shots, bits_per_shot);
+        for (size_t shot = 0; shot < num_shots; shot++) {
+            expected[shot].randomize(bits_per_shot, rng);
+        }
+        RaiiTempNamedFile tmp;
+        FILE *f = fopen(tmp.path.c_str(), "wb");
+        write_table_data<W>(f, num_shots, bits_per_shot, simd_bits<W>(0), expected.transposed(), format, 'M', 'M', 0);
+        fclose(f);
+
+        f = fopen(tmp.path.c_str(), "rb");
+        auto reader = MeasureRecordReader<W>::make(f, format, bits_per_shot);
+        size_t shot = 0;
+
+        // Reading whole records moves the position that bulk reads continue from.
+        size_t record_reads = format == SampleFormat::SAMPLE_FORMAT_PTB64 ? 0 : 3;
+        simd_bits<W> record(bits_per_shot);
+        for (size_t k = 0; k < record_reads; k++) {
+            ASSERT_TRUE(reader->start_and_read_entire_record(record));
+            for (size_t b = 0; b < bits_per_shot; b++) {
+                ASSERT_EQ(record[b], expected[shot][b]);
+            }
+            shot++;
+        }
+
+        simd_bit_table<W> table(bits_per_shot, 128);
+        while (true) {
+            size_t n = reader->read_into_table_with_minor_shot_index(table, 128);
+            for (size_t s = 0; s < n; s++) {
+                for (size_t b = 0; b < bits_per_shot; b++) {
+                    ASSERT_EQ(table[b][s], expected[shot + s][b]) << (int)format << " " << shot + s << " " << b;
+                }
+            }
+            shot += n;
+            if (n < 128) {
+                break;
+            }
+        }
+        ASSERT_EQ(shot, num_shots);
+        ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 128), 0);
+        ASSERT_EQ(getc(f), EOF);
+        fclose(f);
+    }
+})
+
+TEST_EACH_WORD_SIZE_W(MeasureRecordReader, read_minor_shot_index_b8_and_ptb64_truncated, {
+    RaiiTempNamedFile tmp(std::string(10 * 9 + 4, '\x05'));
+    FILE *f = fopen(tmp.path.c_str(), "rb");
+    simd_bit_table<W> table(70, 64);
+    auto b8 = MeasureRecordReader<W>::make(f, SampleFormat::SAMPLE_FORMAT_B8, 70);
+    ASSERT_THROW({ b8->read_into_table_with_minor_shot_index(table, 64); }, std::invalid_argument);
+    ASSERT_EQ(table[0][9], 1);
+    ASSERT_EQ(table[1][9], 0);
+    ASSERT_EQ(table[2][9], 1);
+    fclose(f);
+
+    RaiiTempNamedFile tmp2(std::string(8 * 70 + 8, '\xFF'));
+    f = fopen(tmp2.path.c_str(), "rb");
+    auto ptb64 = MeasureRecordReader<W>::make(f, SampleFormat::SAMPLE_FORMAT_PTB64, 70);
+    ASSERT_EQ(ptb64->read_into_table_with_minor_shot_index(table, 64), 64);
+    ASSERT_EQ(table[69][63], 1);
+    ASSERT_THROW({ ptb64->read_into_table_with_minor_shot_index(table, 64); }, std::invalid_argument);
+    fclose(f);
+})
+
 TEST_EACH_WORD_SIZE_W(MeasureRecordReader, read_windows_newlines_01, {
     FILE *f = tmpfile();
     fprintf(f, "01\r\n01\r\n");
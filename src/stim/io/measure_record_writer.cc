@@ -17,9 +17,105 @@
 #include "stim/io/measure_record_writer.h"
 
 #include <algorithm>
+#include <bit>
+#include <cstring>
 
 using namespace stim;
 
+namespace {
+
+/// Accumulates formatted text on the stack so that it can be passed to fwrite in large chunks.
+struct TextBuffer {
+    FILE *out;
+    char *cur;
+    char buf[1 << 13];
+
+    explicit TextBuffer(FILE *out) : out(out), cur(buf) {
+    }
+    ~TextBuffer() {
+        flush();
+    }
+    /// Ensures there is room for at least n more characters.
+    void reserve(size_t n) {
+        if (cur + n > buf + sizeof(buf)) {
+            flush();
+        }
+    }
+    void flush() {
+        fwrite(buf, 1, cur - buf, out);
+        cur = buf;
+    }
+};
+
+/// Calls the callback with the index of each set bit in the given data, in increasing order.
+template <typename CALLBACK>
+void for_each_set_bit(SpanRef<const uint8_t> data, CALLBACK callback) {
+    const uint8_t *p = data.ptr_start;
+    size_t n = data.size();
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        uint64_t word;
+        memcpy(&word, p + k, 8);
+        while (word) {
+            callback((k << 3) + std::countr_zero(word));
+            word &= word - 1;
+        }
+    }
+    for (; k < n; k++) {
+        uint8_t b = p[k];
+        while (b) {
+            callback((k << 3) + std::countr_zero(b));
+            b &= b - 1;
+        }
+    }
+}
+
+constexpr char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+}  // namespace
+
+char *stim::format_01_bytes(SpanRef<const uint8_t> data, char *out) {
+    for (uint8_t b : data) {
+        // Copy the byte into every lane, keep bit k in lane k, then turn each non-zero lane into a 1.
+        uint64_t lanes = (b * uint64_t{0x0101010101010101}) & uint64_t{0x8040201008040201};
+        lanes = ((lanes + uint64_t{0x7F7F7F7F7F7F7F7F}) >> 7) & uint64_t{0x0101010101010101};
+        lanes += uint64_t{0x3030303030303030};
+        memcpy(out, &lanes, 8);
+        out += 8;
+    }
+    return out;
+}
+
+char *stim::format_decimal(uint64_t value, char *out) {
+    char digits[20];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    while (value >= 100) {
+        p -= 2;
+        memcpy(p, DIGIT_PAIRS + (value % 100) * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, DIGIT_PAIRS + value * 2, 2);
+    } else {
+        *--p = (char)('0' + value);
+    }
+    size_t n = end - p;
+    memcpy(out, p, n);
+    return out + n;
+}
+
 std::unique_ptr<MeasureRecordWriter> MeasureRecordWriter::make(FILE *out, SampleFormat output_format) {
     switch (output_format) {
         case SampleFormat::SAMPLE_FORMAT_01:
@@ -50,6 +146,22 @@ void MeasureRecordWriter::write_bits(uint8_t *data, size_t num_bits) {
     }
 }
 
+void MeasureRecordWriter::write_hits(SpanRef<const uint64_t> sorted_hits, size_t num_bits) {
+    size_t k = 0;
+    for (uint64_t hit : sorted_hits) {
+        while (k < hit) {
+            write_bit(false);
+            k++;
+        }
+        write_bit(true);
+        k++;
+    }
+    while (k < num_bits) {
+        write_bit(false);
+        k++;
+    }
+}
+
 void MeasureRecordWriter::write_bytes(SpanRef<const uint8_t> data) {
     for (uint8_t b : data) {
         for (size_t k = 0; k < 8; k++) {
@@ -61,6 +173,16 @@ void MeasureRecordWriter::write_bytes(SpanRef<const uint8_t> data) {
 MeasureRecordWriterFormat01::MeasureRecordWriterFormat01(FILE *out) : out(out) {
 }
 
+void MeasureRecordWriterFormat01::write_bytes(SpanRef<const uint8_t> data) {
+    TextBuffer text(out);
+    constexpr size_t CHUNK = sizeof(text.buf) / 8;
+    for (const uint8_t *p = data.ptr_start; p < data.ptr_end; p += CHUNK) {
+        const uint8_t *e = std::min(p + CHUNK, data.ptr_end);
+        text.reserve((e - p) * 8);
+        text.cur = format_01_bytes({p, e}, text.cur);
+    }
+}
+
 void MeasureRecordWriterFormat01::write_bit(bool b) {
     putc('0' + b, out);
 }
@@ -102,15 +224,17 @@ MeasureRecordWriterFormatHits::MeasureRecordWriterFormatHits(FILE *out) : out(ou
 }
 
 void MeasureRecordWriterFormatHits::write_bytes(SpanRef<const uint8_t> data) {
-    for (uint8_t b : data) {
-        if (!b) {
-            position += 8;
+    TextBuffer text(out);
+    for_each_set_bit(data, [&](uint64_t k) {
+        text.reserve(21);
+        if (first) {
+            first = false;
         } else {
-            for (size_t k = 0; k < 8; k++) {
-                write_bit((b >> k) & 1);
-            }
+            *text.cur++ = ',';
         }
-    }
+        text.cur = format_decimal(position + k, text.cur);
+    });
+    position += data.size() << 3;
 }
 
 void MeasureRecordWriterFormatHits::write_bit(bool b) {
@@ -120,11 +244,26 @@ void MeasureRecordWriterFormatHits::write_bit(bool b) {
         } else {
             putc(',', out);
         }
-        fprintf(out, "%lld", (unsigned long long)(position));
+        char digits[20];
+        fwrite(digits, 1, format_decimal(position, digits) - digits, out);
     }
     position++;
 }
 
+void MeasureRecordWriterFormatHits::write_hits(SpanRef<const uint64_t> sorted_hits, size_t num_bits) {
+    TextBuffer text(out);
+    for (uint64_t hit : sorted_hits) {
+        text.reserve(21);
+        if (first) {
+            first = false;
+        } else {
+            *text.cur++ = ',';
+        }
+        text.cur = format_decimal(position + hit, text.cur);
+    }
+    position += num_bits;
+}
+
 void MeasureRecordWriterFormatHits::write_end() {
     putc('\n', out);
     position = 0;
@@ -177,15 +316,19 @@ void MeasureRecordWriterFormatDets::begin_result_type(char new_result_type) {
 }
 
 void MeasureRecordWriterFormatDets::write_bytes(SpanRef<const uint8_t> data) {
-    for (uint8_t b : data) {
-        if (!b) {
-            position += 8;
-        } else {
-            for (size_t k = 0; k < 8; k++) {
-                write_bit((b >> k) & 1);
-            }
+    TextBuffer text(out);
+    for_each_set_bit(data, [&](uint64_t k) {
+        text.reserve(26);
+        if (first) {
+            memcpy(text.cur, "shot", 4);
+            text.cur += 4;
+            first = false;
         }
-    }
+        *text.cur++ = ' ';
+        *text.cur++ = result_type;
+        text.cur = format_decimal(position + k, text.cur);
+    });
+    position += data.size() << 3;
 }
 
 void MeasureRecordWriterFormatDets::write_bit(bool b) {
@@ -196,11 +339,28 @@ void MeasureRecordWriterFormatDets::write_bit(bool b) {
         }
         putc(' ', out);
         putc(result_type, out);
-        fprintf(out, "%lld", (unsigned long long)(position));
+        char digits[20];
+        fwrite(digits, 1, format_decimal(position, digits) - digits, out);
     }
     position++;
 }
 
+void MeasureRecordWriterFormatDets::write_hits(SpanRef<const uint64_t> sorted_hits, size_t num_bits) {
+    TextBuffer text(out);
+    for (uint64_t hit : sorted_hits) {
+        text.reserve(26);
+        if (first) {
+            memcpy(text.cur, "shot", 4);
+            text.cur += 4;
+            first = false;
+        }
+        *text.cur++ = ' ';
+        *text.cur++ = result_type;
+        text.cur = format_decimal(position + hit, text.cur);
+    }
+    position += num_bits;
+}
+
 void MeasureRecordWriterFormatDets::write_end() {
     if (first) {
         fprintf(out, "shot");
@@ -25,6 +25,29 @@
 
 namespace stim {
 
+/// Writes bits as '0' and '1' characters into a caller-owned buffer.
+///
+/// Each byte is expanded into eight characters at once (its bits are spread into the lanes of a 64 bit word and then
+/// offset to ASCII), instead of formatting one bit at a time.
+///
+/// Args:
+///     data: The bits to format. Bit k of byte b is character 8*b + k of the output.
+///     out: Where to write the characters. Must have room for 8 * data.size() characters.
+///
+/// Returns:
+///     A pointer just past the last written character.
+char *format_01_bytes(SpanRef<const uint8_t> data, char *out);
+
+/// Writes the decimal representation of a non-negative integer into a caller-owned buffer.
+///
+/// Args:
+///     value: The integer to format.
+///     out: Where to write the digits. Must have room for 20 characters.
+///
+/// Returns:
+///     A pointer just past the last written digit.
+char *format_decimal(uint64_t value, char *out);
+
 /// Handles writing measurement data to the outside world.
 ///
 /// Child classes implement the various output formats.
@@ -40,6 +63,12 @@ struct MeasureRecordWriter {
     virtual void write_end() = 0;
     /// Writes (or buffers) multiple measurement results.
     virtual void write_bits(uint8_t *data, size_t num_bits);
+    /// Writes (or buffers) multiple measurement results, given as the sorted indices of the 1 bits.
+    ///
+    /// Args:
+    ///     sorted_hits: Indices of the 1 bits, relative to the current position, in increasing order.
+    ///     num_bits: The number of results being written. Every hit must be less than this.
+    virtual void write_hits(SpanRef<const uint64_t> sorted_hits, size_t num_bits);
     /// Used to control the DETS format prefix character (M for measurement, D for detector, L for logical observable).
     ///
     /// Setting this is understood to reset the "result index" back to 0 so that e.g. listing logical observables after
@@ -50,6 +79,7 @@ struct MeasureRecordWriter {
 struct MeasureRecordWriterFormat01 : MeasureRecordWriter {
     FILE *out;
     MeasureRecordWriterFormat01(FILE *out);
+    void write_bytes(SpanRef<const uint8_t> data) override;
     void write_bit(bool b) override;
     void write_end() override;
 };
@@ -72,6 +102,7 @@ struct MeasureRecordWriterFormatHits : MeasureRecordWriter {
     MeasureRecordWriterFormatHits(FILE *out);
     void write_bytes(SpanRef<const uint8_t> data) override;
     void write_bit(bool b) override;
+    void write_hits(SpanRef<const uint64_t> sorted_hits, size_t num_bits) override;
     void write_end() override;
 };
 
@@ -95,6 +126,7 @@ struct MeasureRecordWriterFormatDets : MeasureRecordWriter {
     void begin_result_type(char result_type) override;
     void write_bytes(SpanRef<const uint8_t> data) override;
     void write_bit(bool b) override;
+    void write_hits(SpanRef<const uint64_t> sorted_hits, size_t num_bits) override;
     void write_end() override;
 };
 
@@ -141,9 +173,8 @@ void write_table_data(
         } else if (dets_prefix_1 == dets_prefix_2 || dets_prefix_transition >= num_measurements) {
             dets_prefix_transition = num_measurements;
         }
+        auto w = MeasureRecordWriter::make(out, format);
         for (size_t shot = 0; shot < num_shots; shot++) {
-            auto w = MeasureRecordWriter::make(out, format);
-
             w->begin_result_type(dets_prefix_1);
             size_t n8 = dets_prefix_transition >> 3;
             uint8_t *p = result[shot].u8;
@@ -0,0 +1,101 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/io/measure_record_reader.h"
+
+#include "stim/io/measure_record_writer.h"
+
+#include "stim/perf.perf.h"
+#include "stim/util_bot/probability_util.h"
+
+using namespace stim;
+
+template <size_t n, size_t denom, SampleFormat format>
+void writer_benchmark(double goal_micros) {
+    double p = 1 / (double)denom;
+    simd_bits<MAX_BITWORD_WIDTH> data(n);
+    std::mt19937_64 rng(0);
+    biased_randomize_bits(p, data.u64, data.u64 + (n >> 6), rng);
+
+    FILE *f = tmpfile();
+    auto writer = MeasureRecordWriter::make(f, format);
+    benchmark_go([&]() {
+        rewind(f);
+        writer->write_bytes({data.u8, data.u8 + (n >> 3)});
+        writer->write_end();
+    })
+        .goal_micros(goal_micros)
+        .show_rate("Bits", n);
+    if (ftell(f) == 0) {
+        std::cerr << "data dependence!\n";
+    }
+    fclose(f);
+}
+
+template <size_t num_shots, size_t num_bits, size_t denom, SampleFormat format>
+void write_table_data_benchmark(double goal_millis) {
+    double p = 1 / (double)denom;
+    simd_bit_table<MAX_BITWORD_WIDTH> table(num_bits, num_shots);
+    std::mt19937_64 rng(0);
+    biased_randomize_bits(p, table.data.u64, table.data.u64 + (table.data.num_bits_padded() >> 6), rng);
+    simd_bits<MAX_BITWORD_WIDTH> ref(num_bits);
+
+    FILE *f = tmpfile();
+    benchmark_go([&]() {
+        rewind(f);
+        write_table_data(f, num_shots, num_bits, ref, table, format, 'D', 'L', num_bits);
+    })
+        .goal_millis(goal_millis)
+        .show_rate("Bits", num_shots * num_bits);
+    if (ftell(f) == 0) {
+        std::cerr << "data dependence!\n";
+    }
+    fclose(f);
+}
+
+BENCHMARK(write_01_dense_per10) {
+    writer_benchmark<10000, 10, SampleFormat::SAMPLE_FORMAT_01>(0);
+}
+
+BENCHMARK(write_b8_dense_per10) {
+    writer_benchmark<10000, 10, SampleFormat::SAMPLE_FORMAT_B8>(0);
+}
+
+BENCHMARK(write_hits_dense_per10) {
+    writer_benchmark<10000, 10, SampleFormat::SAMPLE_FORMAT_HITS>(0);
+}
+BENCHMARK(write_hits_dense_per100) {
+    writer_benchmark<10000, 100, SampleFormat::SAMPLE_FORMAT_HITS>(0);
+}
+
+BENCHMARK(write_dets_dense_per10) {
+    writer_benchmark<10000, 10, SampleFormat::SAMPLE_FORMAT_DETS>(0);
+}
+BENCHMARK(write_dets_dense_per100) {
+    writer_benchmark<10000, 100, SampleFormat::SAMPLE_FORMAT_DETS>(0);
+}
+
+BENCHMARK(write_r8_dense_per10) {
+    writer_benchmark<10000, 10, SampleFormat::SAMPLE_FORMAT_R8>(0);
+}
+BENCHMARK(write_r8_dense_per100) {
+    writer_benchmark<10000, 100, SampleFormat::SAMPLE_FORMAT_R8>(0);
+}
+
+BENCHMARK(write_table_data_01_1024shots_1000bits) {
+    write_table_data_benchmark<1024, 1000, 10, SampleFormat::SAMPLE_FORMAT_01>(0);
+}
+BENCHMARK(write_table_data_dets_1024shots_1000bits_per100) {
+    write_table_data_benchmark<1024, 1000, 100, SampleFormat::SAMPLE_FORMAT_DETS>(0);
+}
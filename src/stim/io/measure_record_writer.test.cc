@@ -23,6 +23,63 @@
 
 using namespace stim;
 
+TEST(MeasureRecordWriter, format_01_bytes) {
+    uint8_t bytes[]{0x00, 0xFF, 0x05, 0xA0};
+    char buf[33];
+    char *end = format_01_bytes({bytes}, buf);
+    ASSERT_EQ(end, buf + 32);
+    ASSERT_EQ(std::string(buf, end), "00000000111111111010000000000101");
+    ASSERT_EQ(format_01_bytes({bytes, bytes}, buf), buf);
+}
+
+TEST(MeasureRecordWriter, format_decimal) {
+    auto f = [](uint64_t v) {
+        char buf[20];
+        return std::string(buf, format_decimal(v, buf));
+    };
+    ASSERT_EQ(f(0), "0");
+    ASSERT_EQ(f(7), "7");
+    ASSERT_EQ(f(10), "10");
+    ASSERT_EQ(f(99), "99");
+    ASSERT_EQ(f(100), "100");
+    ASSERT_EQ(f(1005), "1005");
+    ASSERT_EQ(f(12345), "12345");
+    ASSERT_EQ(f(UINT64_MAX), "18446744073709551615");
+    for (uint64_t k = 0; k < 100000; k += 7) {
+        ASSERT_EQ(f(k), std::to_string(k));
+    }
+}
+
+TEST(MeasureRecordWriter, write_bytes_matches_write_bit) {
+    std::mt19937_64 rng(0);
+    std::vector<uint8_t> bytes(20000);
+    for (auto &b : bytes) {
+        b = (uint8_t)rng();
+    }
+    bytes[3] = 0;
+    bytes[100] = 0xFF;
+    for (auto format : {SampleFormat::SAMPLE_FORMAT_01, SampleFormat::SAMPLE_FORMAT_HITS, SampleFormat::SAMPLE_FORMAT_DETS}) {
+        FILE *expected = tmpfile();
+        FILE *actual = tmpfile();
+        auto w1 = MeasureRecordWriter::make(expected, format);
+        auto w2 = MeasureRecordWriter::make(actual, format);
+        for (size_t rep = 0; rep < 2; rep++) {
+            w1->begin_result_type('D');
+            w2->begin_result_type('D');
+            for (size_t k = 0; k < bytes.size() * 8; k++) {
+                w1->write_bit((bytes[k >> 3] >> (k & 7)) & 1);
+            }
+            w2->write_bytes({bytes.data(), bytes.data() + 5});
+            w2->write_bytes({bytes.data() + 5, bytes.data() + bytes.size()});
+            w1->write_bit(true);
+            w2->write_bit(true);
+            w1->write_end();
+            w2->write_end();
+        }
+        ASSERT_EQ(rewind_read_close(actual), rewind_read_close(expected));
+    }
+}
+
 TEST(MeasureRecordWriter, Format01) {
     FILE *tmp = tmpfile();
     auto writer = MeasureRecordWriter::make(tmp, SampleFormat::SAMPLE_FORMAT_01);
@@ -440,3 +497,22 @@ TEST(MeasureRecordWriter, write_bits_r8_b) {
     writer->write_end();
     ASSERT_EQ(rewind_read_close(f), std::string("\x00\x00\x00\x00\x00\x00\x00\x00\x03", 9));
 }
+
+TEST(MeasureRecordWriter, write_hits) {
+    std::vector<uint64_t> hits{1, 2, 9};
+    auto write = [&](SampleFormat format) {
+        FILE *f = tmpfile();
+        auto writer = MeasureRecordWriter::make(f, format);
+        writer->begin_result_type('D');
+        writer->write_hits(hits, 11);
+        writer->begin_result_type('L');
+        writer->write_hits({}, 2);
+        writer->write_bit(true);
+        writer->write_end();
+        return rewind_read_close(f);
+    };
+    ASSERT_EQ(write(SampleFormat::SAMPLE_FORMAT_01), "01100000010001\n");
+    ASSERT_EQ(write(SampleFormat::SAMPLE_FORMAT_HITS), "1,2,9,13\n");
+    ASSERT_EQ(write(SampleFormat::SAMPLE_FORMAT_DETS), "shot D1 D2 D9 L2\n");
+    ASSERT_EQ(write(SampleFormat::SAMPLE_FORMAT_B8), std::string("\x06\x22", 2));
+}
@@ -0,0 +1,86 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/io/memory_mapped_file.h"
+
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define STIM_HAS_MMAP 1
+#else
+#define STIM_HAS_MMAP 0
+#endif
+
+using namespace stim;
+
+MemoryMappedFile::MemoryMappedFile() : data(nullptr), size(0) {
+}
+
+MemoryMappedFile::MemoryMappedFile(FILE *file) : data(nullptr), size(0) {
+#if STIM_HAS_MMAP
+    if (file == nullptr) {
+        return;
+    }
+    int fd = fileno(file);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+        return;
+    }
+    void *mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        return;
+    }
+    madvise(mapped, (size_t)info.st_size, MADV_SEQUENTIAL);
+    data = (const uint8_t *)mapped;
+    size = (size_t)info.st_size;
+#else
+    (void)file;
+#endif
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile &&other) noexcept : data(other.data), size(other.size) {
+    other.data = nullptr;
+    other.size = 0;
+}
+
+MemoryMappedFile &MemoryMappedFile::operator=(MemoryMappedFile &&other) noexcept {
+    if (this != &other) {
+        this->~MemoryMappedFile();
+        data = other.data;
+        size = other.size;
+        other.data = nullptr;
+        other.size = 0;
+    }
+    return *this;
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+#if STIM_HAS_MMAP
+    if (data != nullptr) {
+        munmap((void *)data, size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+bool MemoryMappedFile::is_mapped() const {
+    return data != nullptr;
+}
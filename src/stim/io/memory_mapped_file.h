@@ -0,0 +1,56 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_IO_MEMORY_MAPPED_FILE_H
+#define _STIM_IO_MEMORY_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace stim {
+
+/// A read-only memory mapping of the regular file behind a FILE*.
+///
+/// Readers use this to pull large binary inputs straight out of the page cache instead of
+/// copying them through stdio buffers. Mapping is best effort: when the FILE* isn't backed by
+/// a regular file (e.g. a pipe or a terminal), is empty, or the platform doesn't support
+/// mmap, the mapping is left empty and callers should fall back to reading from the FILE*.
+///
+/// The mapping covers the whole file, as it was when the mapping was created. It doesn't track
+/// or move the FILE*'s read position; callers that consume mapped bytes are responsible for
+/// seeking the FILE* past them.
+struct MemoryMappedFile {
+    const uint8_t *data;
+    size_t size;
+
+    /// Creates an empty mapping.
+    MemoryMappedFile();
+    /// Attempts to map the file behind the given FILE*, hinting that it will be read sequentially.
+    explicit MemoryMappedFile(FILE *file);
+    MemoryMappedFile(const MemoryMappedFile &other) = delete;
+    MemoryMappedFile(MemoryMappedFile &&other) noexcept;
+    MemoryMappedFile &operator=(const MemoryMappedFile &other) = delete;
+    MemoryMappedFile &operator=(MemoryMappedFile &&other) noexcept;
+    ~MemoryMappedFile();
+
+    /// Determines if the mapping is usable.
+    bool is_mapped() const;
+};
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/io/memory_mapped_file.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "stim/util_bot/test_util.test.h"
+
+using namespace stim;
+
+TEST(memory_mapped_file, empty) {
+    MemoryMappedFile empty;
+    ASSERT_FALSE(empty.is_mapped());
+    ASSERT_EQ(empty.size, 0);
+
+    MemoryMappedFile null_file(nullptr);
+    ASSERT_FALSE(null_file.is_mapped());
+
+    RaiiTempNamedFile tmp("");
+    FILE *f = fopen(tmp.path.c_str(), "rb");
+    MemoryMappedFile empty_file(f);
+    ASSERT_FALSE(empty_file.is_mapped());
+    fclose(f);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(memory_mapped_file, maps_regular_file) {
+    RaiiTempNamedFile tmp("abcdef");
+    FILE *f = fopen(tmp.path.c_str(), "rb");
+    ASSERT_EQ(getc(f), 'a');
+
+    // The mapping covers the whole file, regardless of the read position.
+    MemoryMappedFile mapped(f);
+    ASSERT_TRUE(mapped.is_mapped());
+    ASSERT_EQ(std::string((const char *)mapped.data, mapped.size), "abcdef");
+    ASSERT_EQ(getc(f), 'b');
+    fclose(f);
+
+    // Still usable after the FILE* is closed.
+    ASSERT_EQ(mapped.data[5], 'f');
+
+    MemoryMappedFile moved(std::move(mapped));
+    ASSERT_FALSE(mapped.is_mapped());
+    ASSERT_TRUE(moved.is_mapped());
+    ASSERT_EQ(moved.size, 6);
+    mapped = std::move(moved);
+    ASSERT_TRUE(mapped.is_mapped());
+    ASSERT_FALSE(moved.is_mapped());
+    ASSERT_EQ(mapped.data[0], 'a');
+}
+
+TEST(memory_mapped_file, pipe_is_not_mapped) {
+    FILE *f = popen("echo test", "r");
+    ASSERT_NE(f, nullptr);
+    MemoryMappedFile mapped(f);
+    ASSERT_FALSE(mapped.is_mapped());
+    pclose(f);
+}
+#endif
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_MEM_SIMD_WORD_512_AVX512_H
+#define _STIM_MEM_SIMD_WORD_512_AVX512_H
+#if __AVX512F__
+
+#include <array>
+#include <bit>
+#include <immintrin.h>
+#include <sstream>
+#include <stdexcept>
+
+#include "stim/mem/bitword.h"
+
+namespace stim {
+
+/// Implements a 512 bit bitword using AVX-512 instructions.
+template <>
+struct bitword<512> {
+    constexpr static size_t BIT_SIZE = 512;
+    constexpr static size_t BIT_POW = 9;
+
+    union {
+        __m512i val;
+        uint8_t u8[64];
+    };
+
+    static void *aligned_malloc(size_t bytes) {
+        return _mm_malloc(bytes, sizeof(__m512i));
+    }
+    static void aligned_free(void *ptr) {
+        _mm_free(ptr);
+    }
+
+    inline bitword() : val(_mm512_setzero_si512()) {
+    }
+    inline bitword(__m512i val) : val(val) {
+    }
+    inline bitword(std::array<uint64_t, 8> val)
+        : val{_mm512_set_epi64(val[7], val[6], val[5], val[4], val[3], val[2], val[1], val[0])} {
+    }
+    inline bitword(uint64_t val) : val{_mm512_set_epi64(0, 0, 0, 0, 0, 0, 0, val)} {
+    }
+    inline bitword(int64_t val)
+        : val{_mm512_set_epi64(
+              -(val < 0), -(val < 0), -(val < 0), -(val < 0), -(val < 0), -(val < 0), -(val < 0), val)} {
+    }
+    inline bitword(int val)
+        : val{_mm512_set_epi64(
+              -(val < 0), -(val < 0), -(val < 0), -(val < 0), -(val < 0), -(val < 0), -(val < 0), val)} {
+    }
+
+    inline static bitword<512> tile8(uint8_t pattern) {
+        return {_mm512_set1_epi8(pattern)};
+    }
+
+    inline static bitword<512> tile16(uint16_t pattern) {
+        return {_mm512_set1_epi16(pattern)};
+    }
+
+    inline static bitword<512> tile32(uint32_t pattern) {
+        return {_mm512_set1_epi32(pattern)};
+    }
+
+    inline static bitword<512> tile64(uint64_t pattern) {
+        return {_mm512_set1_epi64(pattern)};
+    }
+
+    inline std::array<uint64_t, 8> to_u64_array() const {
+        std::array<uint64_t, 8> result;
+        _mm512_storeu_si512(result.data(), val);
+        return result;
+    }
+
+    inline operator bool() const {  // NOLINT(hicpp-explicit-conversions)
+        return _mm512_test_epi64_mask(val, val) != 0;
+    }
+    inline operator int() const {  // NOLINT(hicpp-explicit-conversions)
+        return (int64_t)*this;
+    }
+    inline operator uint64_t() const {  // NOLINT(hicpp-explicit-conversions)
+        auto words = to_u64_array();
+        for (size_t k = 1; k < 8; k++) {
+            if (words[k]) {
+                throw std::invalid_argument("Too large for uint64_t");
+            }
+        }
+        return words[0];
+    }
+    inline operator int64_t() const {  // NOLINT(hicpp-explicit-conversions)
+        auto words = to_u64_array();
+        int64_t result = (int64_t)words[0];
+        uint64_t expected = result < 0 ? (uint64_t)-1 : (uint64_t)0;
+        for (size_t k = 1; k < 8; k++) {
+            if (words[k] != expected) {
+                throw std::invalid_argument("Out of bounds of int64_t");
+            }
+        }
+        return result;
+    }
+
+    inline bitword<512> &operator^=(const bitword<512> &other) {
+        val = _mm512_xor_si512(val, other.val);
+        return *this;
+    }
+
+    inline bitword<512> &operator&=(const bitword<512> &other) {
+        val = _mm512_and_si512(val, other.val);
+        return *this;
+    }
+
+    inline bitword<512> &operator|=(const bitword<512> &other) {
+        val = _mm512_or_si512(val, other.val);
+        return *this;
+    }
+
+    inline bitword<512> operator^(const bitword<512> &other) const {
+        return {_mm512_xor_si512(val, other.val)};
+    }
+
+    inline bitword<512> operator&(const bitword<512> &other) const {
+        return {_mm512_and_si512(val, other.val)};
+    }
+
+    inline bitword<512> operator|(const bitword<512> &other) const {
+        return {_mm512_or_si512(val, other.val)};
+    }
+
+    inline bitword<512> andnot(const bitword<512> &other) const {
+        return {_mm512_andnot_si512(val, other.val)};
+    }
+
+    inline uint16_t popcount() const {
+        auto v = to_u64_array();
+        uint16_t result = 0;
+        for (auto w : v) {
+            result += (uint16_t)std::popcount(w);
+        }
+        return result;
+    }
+
+    inline bitword<512> shifted(int offset) const {
+        auto w = to_u64_array();
+        while (offset <= -64) {
+            for (size_t k = 0; k < 7; k++) {
+                w[k] = w[k + 1];
+            }
+            w[7] = 0;
+            offset += 64;
+        }
+        while (offset >= 64) {
+            for (size_t k = 7; k > 0; k--) {
+                w[k] = w[k - 1];
+            }
+            w[0] = 0;
+            offset -= 64;
+        }
+        std::array<uint64_t, 8> result;
+        if (offset < 0) {
+            offset = -offset;
+            for (size_t k = 0; k < 8; k++) {
+                result[k] = w[k] >> offset;
+                if (offset && k < 7) {
+                    result[k] |= w[k + 1] << (64 - offset);
+                }
+            }
+        } else {
+            for (size_t k = 0; k < 8; k++) {
+                result[k] = w[k] << offset;
+                if (offset && k > 0) {
+                    result[k] |= w[k - 1] >> (64 - offset);
+                }
+            }
+        }
+        return result;
+    }
+
+    inline std::string str() const {
+        std::stringstream out;
+        out << *this;
+        return out.str();
+    }
+
+    inline bool operator==(const bitword<512> &other) const {
+        return _mm512_cmpneq_epi64_mask(val, other.val) == 0;
+    }
+    inline bool operator!=(const bitword<512> &other) const {
+        return !(*this == other);
+    }
+    inline bool operator==(int other) const {
+        return *this == (bitword<512>)other;
+    }
+    inline bool operator!=(int other) const {
+        return *this != (bitword<512>)other;
+    }
+    inline bool operator==(uint64_t other) const {
+        return *this == (bitword<512>)other;
+    }
+    inline bool operator!=(uint64_t other) const {
+        return *this != (bitword<512>)other;
+    }
+    inline bool operator==(int64_t other) const {
+        return *this == (bitword<512>)other;
+    }
+    inline bool operator!=(int64_t other) const {
+        return *this != (bitword<512>)other;
+    }
+
+    template <uint64_t shift>
+    static void inplace_transpose_block_pass(bitword<512> *data, size_t stride, __m512i mask) {
+        for (size_t k = 0; k < 512; k++) {
+            if (k & shift) {
+                continue;
+            }
+            bitword<512> &x = data[stride * k];
+            bitword<512> &y = data[stride * (k + shift)];
+            bitword<512> a = x & mask;
+            bitword<512> b = _mm512_andnot_si512(mask, x.val);
+            bitword<512> c = y & mask;
+            bitword<512> d = _mm512_andnot_si512(mask, y.val);
+            x = a | bitword<512>(_mm512_slli_epi64(c.val, shift));
+            y = bitword<512>(_mm512_srli_epi64(b.val, shift)) | d;
+        }
+    }
+
+    static void inplace_transpose_block_pass_64_and_128_and_256(bitword<512> *data, size_t stride) {
+        uint64_t *ptr = (uint64_t *)data;
+        stride <<= 3;
+
+        for (size_t k = 0; k < 64; k++) {
+            for (size_t i = 0; i < 8; i++) {
+                for (size_t j = i + 1; j < 8; j++) {
+                    std::swap(ptr[stride * (k + 64 * i) + j], ptr[stride * (k + 64 * j) + i]);
+                }
+            }
+        }
+    }
+
+    static void inplace_transpose_square(bitword<512> *data, size_t stride) {
+        inplace_transpose_block_pass<1>(data, stride, _mm512_set1_epi8(0x55));
+        inplace_transpose_block_pass<2>(data, stride, _mm512_set1_epi8(0x33));
+        inplace_transpose_block_pass<4>(data, stride, _mm512_set1_epi8(0xF));
+        inplace_transpose_block_pass<8>(data, stride, _mm512_set1_epi16(0xFF));
+        inplace_transpose_block_pass<16>(data, stride, _mm512_set1_epi32(0xFFFF));
+        inplace_transpose_block_pass<32>(data, stride, _mm512_set1_epi64(0xFFFFFFFF));
+        inplace_transpose_block_pass_64_and_128_and_256(data, stride);
+    }
+};
+
+}  // namespace stim
+
+#endif
+#endif
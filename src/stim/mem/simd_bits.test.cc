@@ -68,7 +68,16 @@ TEST_EACH_WORD_SIZE_W(simd_bits, aliased_editing_and_bit_refs, {
 
 TEST_EACH_WORD_SIZE_W(simd_bits, min_bits_to_num_bits_padded, {
     const auto &f = &min_bits_to_num_bits_padded<W>;
-    if (W == 256) {
+    if (W == 512) {
+        ASSERT_EQ(f(0), 0);
+        ASSERT_EQ(f(1), 512);
+        ASSERT_EQ(f(100), 512);
+        ASSERT_EQ(f(512), 512);
+        ASSERT_EQ(f(513), 1024);
+        ASSERT_EQ(f((1 << 30) - 1), 1 << 30);
+        ASSERT_EQ(f(1 << 30), 1 << 30);
+        ASSERT_EQ(f((1 << 30) + 1), (1 << 30) + 512);
+    } else if (W == 256) {
         ASSERT_EQ(f(0), 0);
         ASSERT_EQ(f(1), 256);
         ASSERT_EQ(f(100), 256);
@@ -105,19 +114,22 @@ TEST_EACH_WORD_SIZE_W(simd_bits, min_bits_to_num_bits_padded, {
 
 TEST_EACH_WORD_SIZE_W(simd_bits, str, {
     simd_bits<W> d(256);
+    std::string padding(d.num_bits_padded() - 256, '_');
     ASSERT_EQ(
         d.str(),
         "________________________________________________________________"
         "________________________________________________________________"
         "________________________________________________________________"
-        "________________________________________________________________");
+        "________________________________________________________________" +
+            padding);
     d[5] = true;
     ASSERT_EQ(
         d.str(),
         "_____1__________________________________________________________"
         "________________________________________________________________"
         "________________________________________________________________"
-        "________________________________________________________________");
+        "________________________________________________________________" +
+            padding);
 })
 
 TEST_EACH_WORD_SIZE_W(simd_bits, randomize, {
@@ -238,7 +250,7 @@ TEST_EACH_WORD_SIZE_W(simd_bits, add_assignment, {
     ASSERT_EQ(m0[0], 0);
     ASSERT_EQ(m0[64], 1);
     // Test carrying across multiple (>=2) words.
-    size_t num_bits = 193;
+    size_t num_bits = std::max<size_t>(193, W - 63);
     simd_bits<W> add(num_bits);
     simd_bits<W> one(num_bits);
     for (size_t word = 0; word < add.num_u64_padded() - 1; word++) {
@@ -578,7 +590,7 @@ TEST_EACH_WORD_SIZE_W(simd_bits, not_zero, {
 })
 
 TEST_EACH_WORD_SIZE_W(simd_bits, word_range_ref, {
-    simd_bits<W> d(1024);
+    simd_bits<W> d(std::max<size_t>(1024, 4 * W));
     const simd_bits<W> &cref = d;
     auto r1 = d.word_range_ref(1, 2);
     auto r2 = d.word_range_ref(2, 2);
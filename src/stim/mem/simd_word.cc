@@ -13,3 +13,46 @@
 // limitations under the License.
 
 #include "stim/mem/simd_word.h"
+
+bool stim::is_bitword_width_supported_by_cpu(size_t width) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    switch (width) {
+        case 512:
+            return __builtin_cpu_supports("avx512f");
+        case 256:
+            return __builtin_cpu_supports("avx2");
+        case 128:
+            return __builtin_cpu_supports("sse2");
+        default:
+            return width == 64;
+    }
+#else
+    return is_bitword_width_compiled(width);
+#endif
+}
+
+size_t stim::choose_bitword_width(size_t requested_width) {
+    if (requested_width != 0) {
+        if (!is_bitword_width_compiled(requested_width)) {
+            throw std::invalid_argument(
+                "Bitword width " + std::to_string(requested_width) +
+                " isn't compiled into this binary. The widest compiled width is " +
+                std::to_string(MAX_BITWORD_WIDTH) + ".");
+        }
+        if (!is_bitword_width_supported_by_cpu(requested_width)) {
+            throw std::invalid_argument(
+                "Bitword width " + std::to_string(requested_width) + " isn't supported by this machine's cpu.");
+        }
+        return requested_width;
+    }
+
+    static const size_t best = []() {
+        size_t w = MAX_BITWORD_WIDTH;
+        while (w > 64 && !is_bitword_width_supported_by_cpu(w)) {
+            w >>= 1;
+        }
+        return w;
+    }();
+    return best;
+}
@@ -16,16 +16,21 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <stdexcept>
+#include <string>
 
 #ifndef _STIM_MEM_SIMD_WORD_H
 #define _STIM_MEM_SIMD_WORD_H
 
 #include "stim/mem/bitword_128_sse.h"
 #include "stim/mem/bitword_256_avx.h"
+#include "stim/mem/bitword_512_avx512.h"
 #include "stim/mem/bitword_64.h"
 
 namespace stim {
-#if __AVX2__
+#if __AVX512F__
+constexpr size_t MAX_BITWORD_WIDTH = 512;
+#elif __AVX2__
 constexpr size_t MAX_BITWORD_WIDTH = 256;
 #elif __SSE2__
 constexpr size_t MAX_BITWORD_WIDTH = 128;
@@ -36,6 +41,66 @@ constexpr size_t MAX_BITWORD_WIDTH = 64;
 template <size_t W>
 using simd_word = bitword<W>;
 
+/// Determines if bitword<W> was compiled into this binary.
+///
+/// The widths that are compiled in are the powers of two from 64 up to MAX_BITWORD_WIDTH.
+constexpr bool is_bitword_width_compiled(size_t width) {
+    return width >= 64 && width <= MAX_BITWORD_WIDTH && (width & (width - 1)) == 0;
+}
+
+/// Determines if the running cpu has the instructions needed to use bitword<W>.
+///
+/// Only meaningful for widths that were compiled into this binary. On machines where the
+/// cpu can't be queried, compiled widths are assumed to be supported.
+bool is_bitword_width_supported_by_cpu(size_t width);
+
+/// Picks the bitword width that width-dispatched code (see `with_bitword_width`) should use.
+///
+/// Args:
+///     requested_width: The width to use (e.g. from a benchmarking flag), or 0 to pick the widest
+///         width that is compiled into this binary and supported by the running cpu.
+///
+/// Returns:
+///     The chosen width.
+///
+/// Throws:
+///     std::invalid_argument: The requested width isn't compiled into this binary or isn't supported
+///         by the running cpu.
+size_t choose_bitword_width(size_t requested_width = 0);
+
+/// Calls `func.template operator()<W>()` where W is the given runtime width.
+///
+/// This is how runtime-chosen widths are turned into template arguments, e.g.
+///
+///     with_bitword_width(choose_bitword_width(), [&]<size_t W>() {
+///         FrameSimulator<W> sim(...);
+///         ...
+///     });
+///
+/// Throws:
+///     std::invalid_argument: The width isn't compiled into this binary.
+template <typename FUNC>
+decltype(auto) with_bitword_width(size_t width, FUNC &&func) {
+    switch (width) {
+#if __AVX512F__
+        case 512:
+            return func.template operator()<512>();
+#endif
+#if __AVX2__
+        case 256:
+            return func.template operator()<256>();
+#endif
+#if __SSE2__
+        case 128:
+            return func.template operator()<128>();
+#endif
+        case 64:
+            return func.template operator()<64>();
+        default:
+            throw std::invalid_argument("Bitword width " + std::to_string(width) + " isn't compiled into this binary.");
+    }
+}
+
 }  // namespace stim
 
 #endif
@@ -37,3 +37,45 @@ BENCHMARK(simd_compat_popcnt) {
         std::cout << '!';
     }
 }
+
+template <size_t W>
+void benchmark_simd_word_xor_and_popcount(double goal_micros) {
+    simd_bits<W> a(1024 * 256);
+    simd_bits<W> b(1024 * 256);
+    std::mt19937_64 rng(0);
+    a.randomize(a.num_bits_padded(), rng);
+    b.randomize(b.num_bits_padded(), rng);
+
+    uint64_t optimization_blocker = 0;
+    benchmark_go([&]() {
+        a ^= b;
+        optimization_blocker += a.popcnt();
+    })
+        .goal_micros(goal_micros)
+        .show_rate("Bits", a.num_bits_padded());
+    if (optimization_blocker == 0) {
+        std::cout << '!';
+    }
+}
+
+BENCHMARK(simd_word_xor_popcnt_w64) {
+    benchmark_simd_word_xor_and_popcount<64>(12);
+}
+
+#if __SSE2__
+BENCHMARK(simd_word_xor_popcnt_w128) {
+    benchmark_simd_word_xor_and_popcount<128>(8);
+}
+#endif
+
+#if __AVX2__
+BENCHMARK(simd_word_xor_popcnt_w256) {
+    benchmark_simd_word_xor_and_popcount<256>(6);
+}
+#endif
+
+#if __AVX512F__
+BENCHMARK(simd_word_xor_popcnt_w512) {
+    benchmark_simd_word_xor_and_popcount<512>(5);
+}
+#endif
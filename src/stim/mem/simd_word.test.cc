@@ -159,3 +159,36 @@ TEST_EACH_WORD_SIZE_W(simd_word, from_u64_array, {
     std::array<uint64_t, W / 64> actual = w.to_u64_array();
     ASSERT_EQ(actual, expected);
 })
+
+TEST(simd_word, choose_bitword_width) {
+    size_t best = choose_bitword_width();
+    ASSERT_TRUE(is_bitword_width_compiled(best));
+    ASSERT_TRUE(is_bitword_width_supported_by_cpu(best));
+    ASSERT_EQ(choose_bitword_width(64), 64);
+    ASSERT_EQ(choose_bitword_width(best), best);
+    for (size_t w = best * 2; w <= MAX_BITWORD_WIDTH; w *= 2) {
+        ASSERT_FALSE(is_bitword_width_supported_by_cpu(w));
+    }
+
+    ASSERT_FALSE(is_bitword_width_compiled(0));
+    ASSERT_FALSE(is_bitword_width_compiled(32));
+    ASSERT_FALSE(is_bitword_width_compiled(96));
+    ASSERT_FALSE(is_bitword_width_compiled(MAX_BITWORD_WIDTH * 2));
+    ASSERT_THROW({ choose_bitword_width(96); }, std::invalid_argument);
+    ASSERT_THROW({ choose_bitword_width(MAX_BITWORD_WIDTH * 2); }, std::invalid_argument);
+}
+
+TEST(simd_word, with_bitword_width) {
+    for (size_t w = 64; w <= MAX_BITWORD_WIDTH; w *= 2) {
+        size_t seen = with_bitword_width(w, [&]<size_t W>() {
+            return simd_word<W>::BIT_SIZE;
+        });
+        ASSERT_EQ(seen, w);
+    }
+    ASSERT_THROW(
+        {
+            with_bitword_width(MAX_BITWORD_WIDTH * 2, [&]<size_t W>() {
+            });
+        },
+        std::invalid_argument);
+}
@@ -20,22 +20,28 @@
 #include <random>
 
 #include "stim/dem/detector_error_model.h"
+#include "stim/io/sparse_shot.h"
 #include "stim/io/stim_data_formats.h"
 #include "stim/mem/simd_bit_table.h"
+#include "stim/simulators/dem_sampling_plan.h"
 
 namespace stim {
 
+/// Errors with probabilities below this threshold are sampled by skipping directly to the
+/// (error, shot) pairs where they fire, instead of generating a dense row of biased bits.
+constexpr double DEM_SAMPLER_SPARSE_PROBABILITY_THRESHOLD = 0.02;
+
 /// Performs high performance bulk sampling of a detector error model.
 ///
 /// The template parameter, W, represents the SIMD width
 template <size_t W>
 struct DemSampler {
     DetectorErrorModel model;
+    DemSamplingPlan plan;  // The model's errors, flattened once so that resampling doesn't re-walk the model.
     uint64_t num_detectors;
     uint64_t num_observables;
     uint64_t num_errors;
     std::mt19937_64 rng;
-    // TODO: allow these buffers to be streamed instead of entirely stored in memory.
     simd_bit_table<W> det_buffer;
     simd_bit_table<W> obs_buffer;
     simd_bit_table<W> err_buffer;
@@ -43,10 +49,34 @@ struct DemSampler {
 
     /// Compiles a sampler for the given detector error model.
     DemSampler(DetectorErrorModel model, std::mt19937_64 &&rng, size_t min_stripes);
+    /// Creates a sampler for the given detector error model, reusing an already compiled plan for it.
+    DemSampler(DetectorErrorModel model, DemSamplingPlan plan, std::mt19937_64 &&rng, size_t min_stripes);
 
     /// Clears the buffers and refills them with sampled shot data.
     void resample(bool replay_errors);
 
+    /// Clears the given buffers and refills them with sampled shot data.
+    ///
+    /// Only reads the sampler's model, so it's safe to call concurrently as long as each
+    /// caller passes its own buffers and rng.
+    ///
+    /// Args:
+    ///     det_out: Detection event data. Major axis is detector index, minor axis is shot index.
+    ///     obs_out: Observable flip data. Major axis is observable index, minor axis is shot index.
+    ///     err_inout: Error data. Major axis is error index, minor axis is shot index. Overwritten
+    ///         with sampled errors, unless replaying errors in which case it's read from. Can be
+    ///         set to nullptr when not replaying errors, to skip recording which errors occurred.
+    ///     replay_errors: When set, errors are taken from err_inout instead of being sampled.
+    ///     rng_to_use: The random number generator to draw entropy from (e.g. std::mt19937_64 or
+    ///         CounterRng).
+    template <typename RNG>
+    void resample_into(
+        simd_bit_table<W> &det_out,
+        simd_bit_table<W> &obs_out,
+        simd_bit_table<W> *err_inout,
+        bool replay_errors,
+        RNG &rng_to_use) const;
+
     /// Ensures the internal buffers are sized for a given number of shots.
     void set_min_stripes(size_t min_stripes);
 
@@ -63,6 +93,12 @@ struct DemSampler {
     ///     replay_err_in: If this argument is given a non-null file, error data will be read from that file
     ///         and replayed (instead of generating new errors randomly).
     ///     replay_err_in_format: The format to read recorded error data to replay in.
+    ///     num_threads: The number of threads to sample with. When this is larger than 1, the
+    ///         shots are split into blocks of `num_stripes` shots that are sampled concurrently,
+    ///         each into its own buffers using a CounterRng stream selected by a single draw from
+    ///         `rng` and the block index. Blocks are written in order, so the output is
+    ///         deterministic for a given seed. Fewer blocks are kept in flight (using fewer
+    ///         threads) when their buffers would otherwise exceed the memory budget.
     void sample_write(
         size_t num_shots,
         FILE *det_out,
@@ -72,7 +108,50 @@ struct DemSampler {
         FILE *err_out,
         SampleFormat err_out_format,
         FILE *replay_err_in,
-        SampleFormat replay_err_in_format);
+        SampleFormat replay_err_in_format,
+        size_t num_threads = 1);
+
+    /// Samples a single shot, producing sparse data instead of filling the dense buffers.
+    ///
+    /// Errors are sampled a probability group at a time, by skipping directly to the errors that
+    /// fire, so the cost is proportional to the number of fired errors (plus the number of groups)
+    /// instead of the number of errors or detectors. Only reads the sampler's model, so it's safe to
+    /// call concurrently as long as each caller passes its own outputs and rng.
+    ///
+    /// Args:
+    ///     det_out: Cleared and then overwritten. The detection events of the shot go into `hits`, in
+    ///         increasing order, and the observable flips go into `obs_mask`.
+    ///     err_out: Cleared and then overwritten. The indices of the errors that fired go into `hits`,
+    ///         in increasing order.
+    ///     rng_to_use: The random number generator to draw entropy from (e.g. std::mt19937_64 or
+    ///         CounterRng).
+    template <typename RNG>
+    void sample_sparse_shot(SparseShot &det_out, SparseShot &err_out, RNG &rng_to_use) const;
+
+    /// Samples from the dem one shot at a time, writing results to files.
+    ///
+    /// Unlike sample_write, this never touches the dense buffers, so the sampler can be constructed
+    /// with min_stripes set to 0 to avoid allocating them. Memory use is then proportional to the
+    /// number of events in a shot, which makes it much cheaper for large models at low
+    /// error rates. Errors can't be replayed, and the ptb64 format isn't supported since it
+    /// interleaves shots.
+    ///
+    /// Args:
+    ///     num_shots: The number of samples to take.
+    ///     det_out: Where to write detection event data. Set to nullptr to not write detection event data.
+    ///     det_out_format: The format to write detection event data in.
+    ///     obs_out: Where to write observable data. Set to nullptr to not write observable data.
+    ///     obs_out_format: The format to write observable data in.
+    ///     err_out: Where to write recorded error data. Set to nullptr to not write recorded error data.
+    ///     err_out_format: The format to write error data in.
+    void sample_write_sparse(
+        size_t num_shots,
+        FILE *det_out,
+        SampleFormat det_out_format,
+        FILE *obs_out,
+        SampleFormat obs_out_format,
+        FILE *err_out,
+        SampleFormat err_out_format);
 };
 
 }  // namespace stim
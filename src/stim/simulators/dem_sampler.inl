@@ -19,6 +19,8 @@
 #include "stim/io/measure_record_reader.h"
 #include "stim/io/measure_record_writer.h"
 #include "stim/simulators/dem_sampler.h"
+#include "stim/simulators/force_streaming.h"
+#include "stim/util_bot/ordered_pipeline.h"
 #include "stim/util_bot/probability_util.h"
 
 namespace stim {
@@ -26,9 +28,25 @@ namespace stim {
 template <size_t W>
 DemSampler<W>::DemSampler(DetectorErrorModel init_model, std::mt19937_64 &&rng, size_t min_stripes)
     : model(std::move(init_model)),
+      plan(DemSamplingPlan::from_model(model)),
       num_detectors(model.count_detectors()),
       num_observables(model.count_observables()),
-      num_errors(model.count_errors()),
+      num_errors(plan.num_errors()),
+      rng(rng),
+      det_buffer((size_t)num_detectors, min_stripes),
+      obs_buffer((size_t)num_observables, min_stripes),
+      err_buffer((size_t)num_errors, min_stripes),
+      num_stripes(det_buffer.num_minor_bits_padded()) {
+}
+
+template <size_t W>
+DemSampler<W>::DemSampler(
+    DetectorErrorModel init_model, DemSamplingPlan init_plan, std::mt19937_64 &&rng, size_t min_stripes)
+    : model(std::move(init_model)),
+      plan(std::move(init_plan)),
+      num_detectors(model.count_detectors()),
+      num_observables(model.count_observables()),
+      num_errors(plan.num_errors()),
       rng(rng),
       det_buffer((size_t)num_detectors, min_stripes),
       obs_buffer((size_t)num_observables, min_stripes),
@@ -49,26 +67,76 @@ void DemSampler<W>::set_min_stripes(size_t min_stripes) {
 
 template <size_t W>
 void DemSampler<W>::resample(bool replay_errors) {
-    det_buffer.clear();
-    obs_buffer.clear();
-    if (!replay_errors) {
-        err_buffer.clear();
+    resample_into(det_buffer, obs_buffer, &err_buffer, replay_errors, rng);
+}
+
+template <size_t W>
+template <typename RNG>
+void DemSampler<W>::resample_into(
+    simd_bit_table<W> &det_out,
+    simd_bit_table<W> &obs_out,
+    simd_bit_table<W> *err_inout,
+    bool replay_errors,
+    RNG &rng_to_use) const {
+    det_out.clear();
+    obs_out.clear();
+
+    auto xor_error_row_into_targets = [&](size_t error_index, simd_bits_range_ref<W> err_row) {
+        for (auto d : plan.error_detectors(error_index)) {
+            det_out[d] ^= err_row;
+        }
+        for (auto o : plan.error_observables(error_index)) {
+            obs_out[o] ^= err_row;
+        }
+    };
+
+    if (replay_errors) {
+        for (size_t e = 0; e < plan.num_errors(); e++) {
+            if ((*err_inout)[e].not_zero()) {
+                xor_error_row_into_targets(e, (*err_inout)[e]);
+            }
+        }
+        return;
     }
-    size_t error_index = 0;
-    model.iter_flatten_error_instructions([&](const DemInstruction &op) {
-        simd_bits_range_ref<W> err_row = err_buffer[error_index];
-        if (!replay_errors) {
-            biased_randomize_bits((float)op.arg_data[0], err_row.u64, err_row.u64 + err_row.num_u64_padded(), rng);
+
+    // When errors aren't being recorded, dense error rows are generated into a scratch row.
+    size_t n = det_out.num_minor_bits_padded();
+    simd_bits<W> scratch_row(err_inout == nullptr ? n : 0);
+    if (err_inout != nullptr) {
+        err_inout->clear();
+    }
+    for (size_t g = 0; g < plan.num_groups(); g++) {
+        double p = plan.group_probabilities[g];
+        auto errors = plan.group_errors(g);
+        if (p == 0) {
+            continue;
         }
-        for (const auto &t : op.target_data) {
-            if (t.is_relative_detector_id()) {
-                det_buffer[(size_t)t.raw_id()] ^= err_row;
-            } else if (t.is_observable_id()) {
-                obs_buffer[(size_t)t.raw_id()] ^= err_row;
+        if (p < DEM_SAMPLER_SPARSE_PROBABILITY_THRESHOLD) {
+            // Rare errors are sampled for the whole group at once, by skipping over the (error, shot)
+            // pairs, and only the fired bits are flipped instead of xoring entire rows.
+            RareErrorIterator::for_samples(p, errors.size() * n, rng_to_use, [&](size_t s) {
+                size_t e = errors[s / n];
+                size_t shot = s % n;
+                uint64_t bit = uint64_t{1} << (shot & 63);
+                size_t word = shot >> 6;
+                if (err_inout != nullptr) {
+                    (*err_inout)[e].u64[word] |= bit;
+                }
+                for (auto d : plan.error_detectors(e)) {
+                    det_out[d].u64[word] ^= bit;
+                }
+                for (auto o : plan.error_observables(e)) {
+                    obs_out[o].u64[word] ^= bit;
+                }
+            });
+        } else {
+            for (auto e : errors) {
+                simd_bits_range_ref<W> err_row = err_inout != nullptr ? (*err_inout)[e] : simd_bits_range_ref<W>(scratch_row);
+                biased_randomize_bits((float)p, err_row.u64, err_row.u64 + err_row.num_u64_padded(), rng_to_use);
+                xor_error_row_into_targets(e, err_row);
             }
         }
-        error_index++;
-    });
+    }
 }
 
 template <size_t W>
@@ -81,48 +149,222 @@ void DemSampler<W>::sample_write(
     FILE *err_out,
     SampleFormat err_out_format,
     FILE *err_in,
-    SampleFormat err_in_format) {
-    for (size_t k = 0; k < num_shots; k += num_stripes) {
-        size_t shots_left = std::min(num_stripes, num_shots - k);
-
-        if (err_in != nullptr) {
-            size_t errors_read = read_file_data_into_shot_table(
-                err_in, shots_left, (size_t)num_errors, err_in_format, 'M', err_buffer, false);
-            if (errors_read != shots_left) {
-                throw std::invalid_argument("Expected more error data for the requested number of shots.");
+    SampleFormat err_in_format,
+    size_t num_threads) {
+    size_t num_blocks = (num_shots + num_stripes - 1) / num_stripes;
+    if (num_threads > num_blocks) {
+        num_threads = num_blocks;
+    }
+
+    // Without threads, the sampler's own buffers and rng are used. With threads, each slot of
+    // the pipeline gets its own buffers and each block of shots gets its own counter-based rng
+    // stream, which can be jumped to directly from the block index.
+    bool threaded = num_threads > 1;
+    bool use_errors = err_out != nullptr || err_in != nullptr;
+    size_t num_slots = threaded ? 2 * num_threads : 1;
+    if (threaded) {
+        // Keep the slots' buffers within the memory budget, by having fewer blocks in flight (and
+        // fewer workers) when the model is large. Block boundaries don't depend on this, so the
+        // output is the same regardless.
+        uint64_t bits_per_slot =
+            (num_detectors + num_observables + (use_errors ? num_errors : 0)) * (uint64_t)num_stripes;
+        num_slots = std::min(num_slots, num_blocks);
+        while (num_slots > 1 &&
+               should_use_streaming_because_bit_count_is_too_large_to_store(bits_per_slot * num_slots)) {
+            num_slots--;
+        }
+        num_threads = std::min(num_threads, num_slots);
+    }
+    uint64_t base_seed = threaded ? rng() : 0;
+    std::vector<simd_bit_table<W>> slot_det;
+    std::vector<simd_bit_table<W>> slot_obs;
+    std::vector<simd_bit_table<W>> slot_err;
+    std::vector<CounterRng> slot_rng;
+    std::vector<size_t> slot_shots(num_slots, 0);
+    if (threaded) {
+        for (size_t k = 0; k < num_slots; k++) {
+            slot_det.emplace_back((size_t)num_detectors, num_stripes);
+            slot_obs.emplace_back((size_t)num_observables, num_stripes);
+            // Only record errors when something is going to read them.
+            slot_err.emplace_back(use_errors ? (size_t)num_errors : 0, use_errors ? num_stripes : 0);
+            slot_rng.emplace_back(0);
+        }
+    }
+    auto det_of = [&](size_t slot) -> simd_bit_table<W> & {
+        return threaded ? slot_det[slot] : det_buffer;
+    };
+    auto obs_of = [&](size_t slot) -> simd_bit_table<W> & {
+        return threaded ? slot_obs[slot] : obs_buffer;
+    };
+    auto err_of = [&](size_t slot) -> simd_bit_table<W> & {
+        return threaded ? slot_err[slot] : err_buffer;
+    };
+
+    size_t shots_assigned = 0;
+    run_ordered_pipeline(
+        num_threads,
+        num_slots,
+        [&](size_t block_index, size_t slot) {
+            if (shots_assigned >= num_shots) {
+                return false;
+            }
+            size_t shots_left = std::min(num_stripes, num_shots - shots_assigned);
+            slot_shots[slot] = shots_left;
+            shots_assigned += shots_left;
+
+            if (err_in != nullptr) {
+                size_t errors_read = read_file_data_into_shot_table(
+                    err_in, shots_left, (size_t)num_errors, err_in_format, 'M', err_of(slot), false);
+                if (errors_read != shots_left) {
+                    throw std::invalid_argument("Expected more error data for the requested number of shots.");
+                }
             }
+            if (threaded) {
+                slot_rng[slot] = CounterRng(base_seed, block_index);
+            }
+            return true;
+        },
+        [&](size_t worker_index, size_t slot) {
+            simd_bit_table<W> *err_table = use_errors ? &err_of(slot) : nullptr;
+            if (threaded) {
+                resample_into(det_of(slot), obs_of(slot), err_table, err_in != nullptr, slot_rng[slot]);
+            } else {
+                resample_into(det_of(slot), obs_of(slot), err_table, err_in != nullptr, rng);
+            }
+        },
+        [&](size_t block_index, size_t slot) {
+            size_t shots_left = slot_shots[slot];
+            if (err_out != nullptr) {
+                write_table_data(
+                    err_out,
+                    shots_left,
+                    (size_t)num_errors,
+                    simd_bits<W>(0),
+                    err_of(slot),
+                    err_out_format,
+                    'M',
+                    'M',
+                    false);
+            }
+
+            if (obs_out != nullptr) {
+                write_table_data(
+                    obs_out,
+                    shots_left,
+                    (size_t)num_observables,
+                    simd_bits<W>(0),
+                    obs_of(slot),
+                    obs_out_format,
+                    'L',
+                    'L',
+                    false);
+            }
+
+            if (det_out != nullptr) {
+                write_table_data(
+                    det_out,
+                    shots_left,
+                    (size_t)num_detectors,
+                    simd_bits<W>(0),
+                    det_of(slot),
+                    det_out_format,
+                    'D',
+                    'D',
+                    false);
+            }
+        });
+}
+
+template <size_t W>
+template <typename RNG>
+void DemSampler<W>::sample_sparse_shot(SparseShot &det_out, SparseShot &err_out, RNG &rng_to_use) const {
+    det_out.clear();
+    err_out.clear();
+    if (det_out.obs_mask.num_bits_padded() < num_observables) {
+        det_out.obs_mask = simd_bits<64>(num_observables);
+    }
+
+    for (size_t g = 0; g < plan.num_groups(); g++) {
+        RareErrorIterator::for_samples(plan.group_probabilities[g], plan.group_errors(g), rng_to_use, [&](uint64_t e) {
+            err_out.hits.push_back(e);
+            for (auto d : plan.error_detectors(e)) {
+                det_out.hits.push_back(d);
+            }
+            for (auto o : plan.error_observables(e)) {
+                det_out.obs_mask[o] ^= true;
+            }
+        });
+    }
+
+    // Groups are visited in order of probability, not error index, so the errors need sorting.
+    std::sort(err_out.hits.begin(), err_out.hits.end());
+
+    // A detector flipped an even number of times didn't fire, so cancel out equal pairs.
+    auto &dets = det_out.hits;
+    std::sort(dets.begin(), dets.end());
+    size_t kept = 0;
+    for (size_t k = 0; k < dets.size(); k++) {
+        if (kept > 0 && dets[kept - 1] == dets[k]) {
+            kept--;
+        } else {
+            dets[kept++] = dets[k];
         }
-        resample(err_in != nullptr);
+    }
+    dets.resize(kept);
+}
+
+template <size_t W>
+void DemSampler<W>::sample_write_sparse(
+    size_t num_shots,
+    FILE *det_out,
+    SampleFormat det_out_format,
+    FILE *obs_out,
+    SampleFormat obs_out_format,
+    FILE *err_out,
+    SampleFormat err_out_format) {
+    if ((det_out != nullptr && det_out_format == SampleFormat::SAMPLE_FORMAT_PTB64) ||
+        (obs_out != nullptr && obs_out_format == SampleFormat::SAMPLE_FORMAT_PTB64) ||
+        (err_out != nullptr && err_out_format == SampleFormat::SAMPLE_FORMAT_PTB64)) {
+        throw std::invalid_argument("The ptb64 format isn't supported when sampling sparsely.");
+    }
+
+    std::unique_ptr<MeasureRecordWriter> det_writer;
+    std::unique_ptr<MeasureRecordWriter> obs_writer;
+    std::unique_ptr<MeasureRecordWriter> err_writer;
+    if (det_out != nullptr) {
+        det_writer = MeasureRecordWriter::make(det_out, det_out_format);
+        det_writer->begin_result_type('D');
+    }
+    if (obs_out != nullptr) {
+        obs_writer = MeasureRecordWriter::make(obs_out, obs_out_format);
+        obs_writer->begin_result_type('L');
+    }
+    if (err_out != nullptr) {
+        err_writer = MeasureRecordWriter::make(err_out, err_out_format);
+        err_writer->begin_result_type('M');
+    }
+
+    SparseShot det_shot;
+    SparseShot err_shot;
+    for (size_t shot = 0; shot < num_shots; shot++) {
+        sample_sparse_shot(det_shot, err_shot, rng);
 
-        if (err_out != nullptr) {
-            write_table_data(
-                err_out, shots_left, (size_t)num_errors, simd_bits<W>(0), err_buffer, err_out_format, 'M', 'M', false);
+        if (err_writer != nullptr) {
+            err_writer->write_hits(err_shot.hits, (size_t)num_errors);
+            err_writer->write_end();
+            err_writer->begin_result_type('M');
         }
 
-        if (obs_out != nullptr) {
-            write_table_data(
-                obs_out,
-                shots_left,
-                (size_t)num_observables,
-                simd_bits<W>(0),
-                obs_buffer,
-                obs_out_format,
-                'L',
-                'L',
-                false);
+        if (obs_writer != nullptr) {
+            obs_writer->write_bits(det_shot.obs_mask.u8, (size_t)num_observables);
+            obs_writer->write_end();
+            obs_writer->begin_result_type('L');
         }
 
-        if (det_out != nullptr) {
-            write_table_data(
-                det_out,
-                shots_left,
-                (size_t)num_detectors,
-                simd_bits<W>(0),
-                det_buffer,
-                det_out_format,
-                'D',
-                'D',
-                false);
+        if (det_writer != nullptr) {
+            det_writer->write_hits(det_shot.hits, (size_t)num_detectors);
+            det_writer->write_end();
+            det_writer->begin_result_type('D');
         }
     }
 }
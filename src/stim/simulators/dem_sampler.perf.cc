@@ -39,3 +39,22 @@ BENCHMARK(DemSampler_surface_code_rotated_memory_z_distance11_100rounds_1024stri
         std::cerr << "Data dependence.";
     }
 }
+
+BENCHMARK(DemSampler_surface_code_rotated_memory_z_distance5_5rounds_64stripes) {
+    auto params = CircuitGenParameters(5, 5, "rotated_memory_z");
+    params.before_measure_flip_probability = 0.001;
+    params.after_reset_flip_probability = 0.001;
+    params.after_clifford_depolarization = 0.001;
+    auto circuit = generate_surface_code_circuit(params).circuit;
+    auto dem = ErrorAnalyzer::circuit_to_detector_error_model(circuit, true, true, false, false, false, false);
+    DemSampler<MAX_BITWORD_WIDTH> sampler(dem, std::mt19937_64(0), 64);
+    size_t count = 0;
+    benchmark_go([&]() {
+        sampler.resample(false);
+        count += sampler.det_buffer[0].popcnt();
+        count += sampler.obs_buffer[0].popcnt();
+    }).goal_micros(15);
+    if (count == 0) {
+        std::cerr << "Data dependence.";
+    }
+}
@@ -48,7 +48,7 @@ pybind11::object dem_sampler_py_sample(
 
     bool replay = !recorded_errors_to_replay.is_none();
     if (replay && min_bits_to_num_bits_padded<MAX_BITWORD_WIDTH>(shots) != self.num_stripes) {
-        DemSampler<MAX_BITWORD_WIDTH> perfect_size(self.model, std::move(self.rng), shots);
+        DemSampler<MAX_BITWORD_WIDTH> perfect_size(self.model, self.plan, std::move(self.rng), shots);
         auto result = dem_sampler_py_sample(perfect_size, shots, bit_packed, return_errors, recorded_errors_to_replay);
         self.rng = std::move(perfect_size.rng);
         return result;
@@ -17,6 +17,7 @@
 #include "gtest/gtest.h"
 
 #include "stim/mem/simd_word.test.h"
+#include "stim/simulators/force_streaming.h"
 #include "stim/util_bot/test_util.test.h"
 
 using namespace stim;
@@ -98,3 +99,253 @@ TEST_EACH_WORD_SIZE_W(DemSampler, resample_combinations, {
         ASSERT_FALSE(total.not_zero());
     }
 })
+
+TEST_EACH_WORD_SIZE_W(DemSampler, sample_write_threaded, {
+    DetectorErrorModel dem(R"DEM(
+        error(0.1) D0 D1
+        error(0.2) D1 D2 L0
+        error(0.3) D2 D0
+        error(0.5) D3
+    )DEM");
+    auto sample = [&](size_t num_threads, uint64_t seed) {
+        DemSampler<W> sampler(dem, std::mt19937_64(seed), 256);
+        FILE *det_out = tmpfile();
+        FILE *obs_out = tmpfile();
+        FILE *err_out = tmpfile();
+        sampler.sample_write(
+            3000,
+            det_out,
+            SampleFormat::SAMPLE_FORMAT_01,
+            obs_out,
+            SampleFormat::SAMPLE_FORMAT_01,
+            err_out,
+            SampleFormat::SAMPLE_FORMAT_B8,
+            nullptr,
+            SampleFormat::SAMPLE_FORMAT_01,
+            num_threads);
+        return std::array<std::string, 3>{
+            rewind_read_close(det_out),
+            rewind_read_close(obs_out),
+            rewind_read_close(err_out),
+        };
+    };
+
+    auto a = sample(3, 5);
+    ASSERT_EQ(a, sample(3, 5));
+    ASSERT_EQ(a, sample(8, 5));
+    ASSERT_NE(a, sample(3, 6));
+    ASSERT_EQ(a[0].size(), 3000 * 5);
+    ASSERT_EQ(a[1].size(), 3000 * 2);
+    ASSERT_EQ(a[2].size(), 3000);
+
+    {
+        // Buffers that don't fit in the memory budget reduce the blocks in flight, not the output.
+        DebugForceResultStreamingRaii force_small_memory_budget;
+        ASSERT_EQ(a, sample(3, 5));
+    }
+
+    // Not recording errors doesn't change the sampled detection events.
+    DemSampler<W> no_err_sampler(dem, std::mt19937_64(5), 256);
+    FILE *no_err_det_out = tmpfile();
+    no_err_sampler.sample_write(
+        3000,
+        no_err_det_out,
+        SampleFormat::SAMPLE_FORMAT_01,
+        nullptr,
+        SampleFormat::SAMPLE_FORMAT_01,
+        nullptr,
+        SampleFormat::SAMPLE_FORMAT_01,
+        nullptr,
+        SampleFormat::SAMPLE_FORMAT_01,
+        3);
+    ASSERT_EQ(rewind_read_close(no_err_det_out), a[0]);
+
+    size_t d3_hits = 0;
+    for (size_t k = 3; k < a[0].size(); k += 5) {
+        d3_hits += a[0][k] == '1';
+    }
+    ASSERT_GT(d3_hits, 1200);
+    ASSERT_LT(d3_hits, 1800);
+
+    // Replaying the recorded errors on several threads reproduces the detection events.
+    FILE *err_in = tmpfile();
+    fwrite(a[2].data(), 1, a[2].size(), err_in);
+    rewind(err_in);
+    FILE *det_out = tmpfile();
+    FILE *obs_out = tmpfile();
+    DemSampler<W> replayer(dem, std::mt19937_64(0), 256);
+    replayer.sample_write(
+        3000,
+        det_out,
+        SampleFormat::SAMPLE_FORMAT_01,
+        obs_out,
+        SampleFormat::SAMPLE_FORMAT_01,
+        nullptr,
+        SampleFormat::SAMPLE_FORMAT_01,
+        err_in,
+        SampleFormat::SAMPLE_FORMAT_B8,
+        4);
+    fclose(err_in);
+    ASSERT_EQ(rewind_read_close(det_out), a[0]);
+    ASSERT_EQ(rewind_read_close(obs_out), a[1]);
+})
+
+TEST_EACH_WORD_SIZE_W(DemSampler, resample_rare_errors_consistent_with_recorded_errors, {
+    DemSampler<W> sampler(
+        DetectorErrorModel(R"DEM(
+            error(0.01) D0 D1
+            error(0.01) D1 L0
+            error(0.005) D2 D2 D3
+         )DEM"),
+        INDEPENDENT_TEST_RNG(),
+        10000);
+    sampler.resample(false);
+    ASSERT_GT(sampler.err_buffer[0].popcnt(), 50);
+    ASSERT_LT(sampler.err_buffer[0].popcnt(), 150);
+    ASSERT_GT(sampler.err_buffer[1].popcnt(), 50);
+    ASSERT_LT(sampler.err_buffer[1].popcnt(), 150);
+    ASSERT_GT(sampler.err_buffer[2].popcnt(), 15);
+    ASSERT_LT(sampler.err_buffer[2].popcnt(), 85);
+
+    simd_bits<W> expected = sampler.err_buffer[0];
+    ASSERT_EQ(sampler.det_buffer[0], expected);
+    expected ^= sampler.err_buffer[1];
+    ASSERT_EQ(sampler.det_buffer[1], expected);
+    ASSERT_FALSE(sampler.det_buffer[2].not_zero());
+    ASSERT_EQ(sampler.det_buffer[3], sampler.err_buffer[2]);
+    ASSERT_EQ(sampler.obs_buffer[0], sampler.err_buffer[1]);
+})
+
+TEST_EACH_WORD_SIZE_W(DemSampler, sample_sparse_shot, {
+    DemSampler<W> sampler(
+        DetectorErrorModel(R"DEM(
+            error(0) D0
+            error(0.25) D1 L0
+            error(0.01) D2 D2 D3
+            error(1) D4 D5 L1
+            error(0.5) D5 D1
+         )DEM"),
+        INDEPENDENT_TEST_RNG(),
+        1);
+    SparseShot det_shot;
+    SparseShot err_shot;
+    std::array<size_t, 5> error_counts{};
+    for (size_t k = 0; k < 10000; k++) {
+        sampler.sample_sparse_shot(det_shot, err_shot, sampler.rng);
+        ASSERT_TRUE(std::is_sorted(err_shot.hits.begin(), err_shot.hits.end()));
+        ASSERT_TRUE(std::is_sorted(det_shot.hits.begin(), det_shot.hits.end()));
+
+        simd_bits<W> expected_dets(6);
+        simd_bits<W> expected_obs(2);
+        for (auto e : err_shot.hits) {
+            error_counts[e]++;
+            if (e == 1) {
+                expected_dets[1] ^= true;
+                expected_obs[0] ^= true;
+            } else if (e == 2) {
+                expected_dets[3] ^= true;
+            } else if (e == 3) {
+                expected_dets[4] ^= true;
+                expected_dets[5] ^= true;
+                expected_obs[1] ^= true;
+            } else if (e == 4) {
+                expected_dets[5] ^= true;
+                expected_dets[1] ^= true;
+            }
+        }
+        simd_bits<W> actual_dets(6);
+        for (auto d : det_shot.hits) {
+            ASSERT_FALSE(actual_dets[d]);
+            actual_dets[d] = true;
+        }
+        ASSERT_EQ(actual_dets, expected_dets);
+        ASSERT_EQ(det_shot.obs_mask_as_u64(), expected_obs.u64[0]);
+    }
+    ASSERT_EQ(error_counts[0], 0);
+    ASSERT_GT(error_counts[1], 2500 - 300);
+    ASSERT_LT(error_counts[1], 2500 + 300);
+    ASSERT_GT(error_counts[2], 100 - 60);
+    ASSERT_LT(error_counts[2], 100 + 60);
+    ASSERT_EQ(error_counts[3], 10000);
+    ASSERT_GT(error_counts[4], 5000 - 400);
+    ASSERT_LT(error_counts[4], 5000 + 400);
+})
+
+TEST_EACH_WORD_SIZE_W(DemSampler, sample_write_sparse, {
+    DetectorErrorModel dem(R"DEM(
+        error(0.01) D0 D1
+        error(0.02) D1 D2 L0
+        error(0.001) D2 D0
+        error(0.5) D3
+        repeat 100 {
+            error(0.001) D4 L1
+            shift_detectors 1
+        }
+    )DEM");
+    DemSampler<W> sampler(dem, INDEPENDENT_TEST_RNG(), 0);
+    ASSERT_EQ(sampler.err_buffer.data.num_bits_padded(), 0);
+    FILE *det_out = tmpfile();
+    FILE *obs_out = tmpfile();
+    FILE *err_out = tmpfile();
+    sampler.sample_write_sparse(
+        500,
+        det_out,
+        SampleFormat::SAMPLE_FORMAT_DETS,
+        obs_out,
+        SampleFormat::SAMPLE_FORMAT_01,
+        err_out,
+        SampleFormat::SAMPLE_FORMAT_HITS);
+    auto dets = rewind_read_close(det_out);
+    auto obs = rewind_read_close(obs_out);
+    ASSERT_EQ(obs.size(), 500 * 3);
+
+    // Replaying the recorded errors through the dense sampler reproduces the detection events.
+    rewind(err_out);
+    FILE *replay_det_out = tmpfile();
+    FILE *replay_obs_out = tmpfile();
+    DemSampler<W> replayer(dem, std::mt19937_64(0), 256);
+    replayer.sample_write(
+        500,
+        replay_det_out,
+        SampleFormat::SAMPLE_FORMAT_DETS,
+        replay_obs_out,
+        SampleFormat::SAMPLE_FORMAT_01,
+        nullptr,
+        SampleFormat::SAMPLE_FORMAT_01,
+        err_out,
+        SampleFormat::SAMPLE_FORMAT_HITS);
+    fclose(err_out);
+    ASSERT_EQ(rewind_read_close(replay_det_out), dets);
+    ASSERT_EQ(rewind_read_close(replay_obs_out), obs);
+
+    ASSERT_THROW(
+        {
+            sampler.sample_write_sparse(
+                64,
+                stdout,
+                SampleFormat::SAMPLE_FORMAT_PTB64,
+                nullptr,
+                SampleFormat::SAMPLE_FORMAT_01,
+                nullptr,
+                SampleFormat::SAMPLE_FORMAT_01);
+        },
+        std::invalid_argument);
+})
+
+TEST_EACH_WORD_SIZE_W(DemSampler, reuse_compiled_plan, {
+    DetectorErrorModel dem(R"DEM(
+        error(0.01) D0 D1
+        error(0.25) D1 L0
+    )DEM");
+    DemSampler<W> a(dem, std::mt19937_64(5), 256);
+    DemSampler<W> b(dem, a.plan, std::mt19937_64(5), 512);
+    ASSERT_EQ(b.num_errors, 2);
+    ASSERT_EQ(b.num_detectors, 2);
+    ASSERT_EQ(b.num_observables, 1);
+    a.set_min_stripes(512);
+    a.resample(false);
+    b.resample(false);
+    ASSERT_EQ(a.det_buffer, b.det_buffer);
+    ASSERT_EQ(a.obs_buffer, b.obs_buffer);
+    ASSERT_EQ(a.err_buffer, b.err_buffer);
+})
@@ -0,0 +1,78 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/simulators/dem_sampling_plan.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace stim;
+
+DemSamplingPlan DemSamplingPlan::from_model(const DetectorErrorModel &model) {
+    DemSamplingPlan plan;
+    plan.detector_starts.push_back(0);
+    plan.observable_starts.push_back(0);
+    model.iter_flatten_error_instructions([&](const DemInstruction &op) {
+        for (const auto &t : op.target_data) {
+            if (t.is_relative_detector_id()) {
+                plan.detectors.push_back(t.raw_id());
+            } else if (t.is_observable_id()) {
+                plan.observables.push_back(t.raw_id());
+            }
+        }
+        plan.detector_starts.push_back(plan.detectors.size());
+        plan.observable_starts.push_back(plan.observables.size());
+        plan.probabilities.push_back(op.arg_data[0]);
+    });
+
+    std::vector<uint64_t> order(plan.probabilities.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint64_t a, uint64_t b) {
+        return plan.probabilities[a] < plan.probabilities[b];
+    });
+    for (size_t k = 0; k < order.size(); k++) {
+        double p = plan.probabilities[order[k]];
+        if (k == 0 || p != plan.group_probabilities.back()) {
+            plan.group_probabilities.push_back(p);
+            plan.group_starts.push_back(k);
+        }
+    }
+    plan.group_starts.push_back(order.size());
+    plan.grouped_errors = std::move(order);
+
+    return plan;
+}
+
+size_t DemSamplingPlan::num_errors() const {
+    return probabilities.size();
+}
+
+size_t DemSamplingPlan::num_groups() const {
+    return group_probabilities.size();
+}
+
+SpanRef<const uint64_t> DemSamplingPlan::error_detectors(size_t error_index) const {
+    const uint64_t *p = detectors.data();
+    return {p + detector_starts[error_index], p + detector_starts[error_index + 1]};
+}
+
+SpanRef<const uint64_t> DemSamplingPlan::error_observables(size_t error_index) const {
+    const uint64_t *p = observables.data();
+    return {p + observable_starts[error_index], p + observable_starts[error_index + 1]};
+}
+
+SpanRef<const uint64_t> DemSamplingPlan::group_errors(size_t group_index) const {
+    const uint64_t *p = grouped_errors.data();
+    return {p + group_starts[group_index], p + group_starts[group_index + 1]};
+}
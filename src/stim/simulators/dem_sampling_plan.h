@@ -0,0 +1,64 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_SIMULATORS_DEM_SAMPLING_PLAN_H
+#define _STIM_SIMULATORS_DEM_SAMPLING_PLAN_H
+
+#include <cstdint>
+#include <vector>
+
+#include "stim/dem/detector_error_model.h"
+#include "stim/mem/span_ref.h"
+
+namespace stim {
+
+/// A detector error model flattened into a form that's cheap to sample from repeatedly.
+///
+/// Iterating a DetectorErrorModel's error instructions requires unrolling repeat blocks,
+/// applying detector shifts, and classifying targets. The plan does that work once, storing
+/// each error's detectors and observables in flat compressed-sparse-row arrays. It also groups
+/// errors with identical probabilities, so that a single geometric skipping pass can sample
+/// every error in a group.
+struct DemSamplingPlan {
+    /// Error k flips the detectors detectors[detector_starts[k]:detector_starts[k+1]].
+    std::vector<uint64_t> detector_starts;
+    std::vector<uint64_t> detectors;
+    /// Error k flips the observables observables[observable_starts[k]:observable_starts[k+1]].
+    std::vector<uint64_t> observable_starts;
+    std::vector<uint64_t> observables;
+    /// The probability of each error, indexed by error index.
+    std::vector<double> probabilities;
+
+    /// Group g contains the errors grouped_errors[group_starts[g]:group_starts[g+1]], which all have
+    /// probability group_probabilities[g]. Errors within a group are in increasing order, and groups
+    /// are in increasing order of probability.
+    std::vector<double> group_probabilities;
+    std::vector<uint64_t> group_starts;
+    std::vector<uint64_t> grouped_errors;
+
+    /// Compiles a plan for sampling the given detector error model.
+    static DemSamplingPlan from_model(const DetectorErrorModel &model);
+
+    size_t num_errors() const;
+    size_t num_groups() const;
+    SpanRef<const uint64_t> error_detectors(size_t error_index) const;
+    SpanRef<const uint64_t> error_observables(size_t error_index) const;
+    SpanRef<const uint64_t> group_errors(size_t group_index) const;
+};
+
+}  // namespace stim
+
+#endif
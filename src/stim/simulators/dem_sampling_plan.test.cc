@@ -0,0 +1,63 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/simulators/dem_sampling_plan.h"
+
+#include "gtest/gtest.h"
+
+using namespace stim;
+
+static std::vector<uint64_t> vec(SpanRef<const uint64_t> items) {
+    return {items.begin(), items.end()};
+}
+
+TEST(DemSamplingPlan, empty) {
+    auto plan = DemSamplingPlan::from_model(DetectorErrorModel(R"DEM(
+        detector D5
+        logical_observable L2
+    )DEM"));
+    ASSERT_EQ(plan.num_errors(), 0);
+    ASSERT_EQ(plan.num_groups(), 0);
+    ASSERT_EQ(plan.group_starts, (std::vector<uint64_t>{0}));
+}
+
+TEST(DemSamplingPlan, flattens_and_groups) {
+    auto plan = DemSamplingPlan::from_model(DetectorErrorModel(R"DEM(
+        error(0.25) D0 D1 ^ L2
+        repeat 2 {
+            error(0.125) D0 L0 L1
+            shift_detectors 3
+        }
+        error(0.25) D2
+        error(0) D0
+    )DEM"));
+    ASSERT_EQ(plan.num_errors(), 5);
+    ASSERT_EQ(plan.probabilities, (std::vector<double>{0.25, 0.125, 0.125, 0.25, 0}));
+    ASSERT_EQ(vec(plan.error_detectors(0)), (std::vector<uint64_t>{0, 1}));
+    ASSERT_EQ(vec(plan.error_observables(0)), (std::vector<uint64_t>{2}));
+    ASSERT_EQ(vec(plan.error_detectors(1)), (std::vector<uint64_t>{0}));
+    ASSERT_EQ(vec(plan.error_observables(1)), (std::vector<uint64_t>{0, 1}));
+    ASSERT_EQ(vec(plan.error_detectors(2)), (std::vector<uint64_t>{3}));
+    ASSERT_EQ(vec(plan.error_observables(2)), (std::vector<uint64_t>{0, 1}));
+    ASSERT_EQ(vec(plan.error_detectors(3)), (std::vector<uint64_t>{8}));
+    ASSERT_EQ(vec(plan.error_observables(3)), (std::vector<uint64_t>{}));
+    ASSERT_EQ(vec(plan.error_detectors(4)), (std::vector<uint64_t>{6}));
+    ASSERT_EQ(vec(plan.error_observables(4)), (std::vector<uint64_t>{}));
+
+    ASSERT_EQ(plan.num_groups(), 3);
+    ASSERT_EQ(plan.group_probabilities, (std::vector<double>{0, 0.125, 0.25}));
+    ASSERT_EQ(vec(plan.group_errors(0)), (std::vector<uint64_t>{4}));
+    ASSERT_EQ(vec(plan.group_errors(1)), (std::vector<uint64_t>{1, 2}));
+    ASSERT_EQ(vec(plan.group_errors(2)), (std::vector<uint64_t>{0, 3}));
+}
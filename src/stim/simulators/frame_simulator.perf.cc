@@ -123,3 +123,49 @@ BENCHMARK(FrameSimulator_surface_code_rotated_memory_z_d11_r100_batch1024) {
         std::cerr << "data dependence";
     }
 }
+
+template <size_t W>
+void benchmark_frame_simulator_surface_code_at_width(double goal_millis) {
+    auto params = CircuitGenParameters(100, 11, "rotated_memory_z");
+    params.before_measure_flip_probability = 0.001;
+    params.after_reset_flip_probability = 0.001;
+    params.after_clifford_depolarization = 0.001;
+    auto circuit = generate_surface_code_circuit(params).circuit;
+
+    FrameSimulator<W> sim(
+        circuit.compute_stats(), FrameSimulatorMode::STORE_MEASUREMENTS_TO_MEMORY, 1024, std::mt19937_64(0));
+
+    benchmark_go([&]() {
+        sim.reset_all();
+        sim.do_circuit(circuit);
+    })
+        .goal_millis(goal_millis)
+        .show_rate("Shots", 1024)
+        .show_rate("Dets", circuit.count_detectors() * 1024);
+    sim.reset_all();
+    if (!sim.obs_record[0].not_zero()) {
+        std::cerr << "data dependence";
+    }
+}
+
+BENCHMARK(FrameSimulator_surface_code_rotated_memory_z_d11_r100_batch1024_w64) {
+    benchmark_frame_simulator_surface_code_at_width<64>(12);
+}
+
+#if __SSE2__
+BENCHMARK(FrameSimulator_surface_code_rotated_memory_z_d11_r100_batch1024_w128) {
+    benchmark_frame_simulator_surface_code_at_width<128>(8);
+}
+#endif
+
+#if __AVX2__
+BENCHMARK(FrameSimulator_surface_code_rotated_memory_z_d11_r100_batch1024_w256) {
+    benchmark_frame_simulator_surface_code_at_width<256>(5.1);
+}
+#endif
+
+#if __AVX512F__
+BENCHMARK(FrameSimulator_surface_code_rotated_memory_z_d11_r100_batch1024_w512) {
+    benchmark_frame_simulator_surface_code_at_width<512>(4);
+}
+#endif
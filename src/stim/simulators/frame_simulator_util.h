@@ -64,6 +64,11 @@ std::pair<simd_bit_table<W>, simd_bit_table<W>> sample_batch_detection_events(
 ///     obs_out: An optional secondary file to write observable data to. Set to nullptr to
 ///         not use.
 ///     obs_out_format: The format to use when writing to the secondary file.
+///     num_threads: The number of threads to simulate batches on. When this is larger than 1,
+///         each batch of shots is simulated by its own FrameSimulator using an rng stream
+///         derived from a single draw from `rng` and the batch index. Batches are written
+///         in order, so the output is deterministic for a given seed. (Circuits too large to
+///         fit a batch in memory ignore this argument and stream on one thread.)
 template <size_t W>
 void sample_batch_detection_events_writing_results_to_disk(
     const Circuit &circuit,
@@ -74,7 +79,8 @@ void sample_batch_detection_events_writing_results_to_disk(
     SampleFormat format,
     std::mt19937_64 &rng,
     FILE *obs_out,
-    SampleFormat obs_out_format);
+    SampleFormat obs_out_format,
+    size_t num_threads = 1);
 
 /// A convenience method for batch sampling measurements from a circuit.
 ///
@@ -15,6 +15,8 @@
 #include "stim/simulators/force_streaming.h"
 #include "stim/simulators/frame_simulator.h"
 #include "stim/simulators/frame_simulator_util.h"
+#include "stim/util_bot/ordered_pipeline.h"
+#include "stim/util_bot/probability_util.h"
 
 namespace stim {
 
@@ -52,7 +54,7 @@ void rerun_frame_sim_while_streaming_dets_to_disk(
             "results");
     }
 
-    MeasureRecordBatchWriter writer(out, num_shots, format);
+    MeasureRecordBatchWriter writer(out, num_shots, format, true);
     std::vector<simd_bits<W>> observables;
     sim.reset_all();
     writer.begin_result_type('D');
@@ -102,7 +104,7 @@ void rerun_frame_sim_while_streaming_measurements_to_disk(
     size_t num_shots,
     FILE *out,
     SampleFormat format) {
-    MeasureRecordBatchWriter writer(out, num_shots, format);
+    MeasureRecordBatchWriter writer(out, num_shots, format, true);
     sim.reset_all();
     circuit.for_each_operation([&](const CircuitInstruction &op) {
         sim.do_gate(op);
@@ -112,10 +114,9 @@ void rerun_frame_sim_while_streaming_measurements_to_disk(
 }
 
 template <size_t W>
-void rerun_frame_sim_in_memory_and_write_dets_to_disk(
-    const Circuit &circuit,
+void write_frame_sim_dets_to_disk(
     const CircuitStats &circuit_stats,
-    FrameSimulator<W> &frame_sim,
+    const FrameSimulator<W> &frame_sim,
     simd_bit_table<W> &out_concat_buf,
     size_t num_shots,
     bool prepend_observables,
@@ -128,9 +129,6 @@ void rerun_frame_sim_in_memory_and_write_dets_to_disk(
         throw std::out_of_range("Can't combine --prepend_observables, --append_observables, or --obs_out");
     }
 
-    frame_sim.reset_all();
-    frame_sim.do_circuit(circuit);
-
     const auto &obs_data = frame_sim.obs_record;
     const auto &det_data = frame_sim.det_record.storage;
     if (obs_out != nullptr) {
@@ -186,6 +184,105 @@ void rerun_frame_sim_in_memory_and_write_dets_to_disk(
     }
 }
 
+template <size_t W>
+void rerun_frame_sim_in_memory_and_write_dets_to_disk(
+    const Circuit &circuit,
+    const CircuitStats &circuit_stats,
+    FrameSimulator<W> &frame_sim,
+    simd_bit_table<W> &out_concat_buf,
+    size_t num_shots,
+    bool prepend_observables,
+    bool append_observables,
+    FILE *out,
+    SampleFormat format,
+    FILE *obs_out,
+    SampleFormat obs_out_format) {
+    frame_sim.reset_all();
+    frame_sim.do_circuit(circuit);
+
+    write_frame_sim_dets_to_disk(
+        circuit_stats,
+        frame_sim,
+        out_concat_buf,
+        num_shots,
+        prepend_observables,
+        append_observables,
+        out,
+        format,
+        obs_out,
+        obs_out_format);
+}
+
+template <size_t W>
+void sample_dets_in_parallel_and_write_to_disk(
+    const Circuit &circuit,
+    const CircuitStats &circuit_stats,
+    size_t batch_size,
+    size_t num_shots,
+    bool prepend_observables,
+    bool append_observables,
+    FILE *out,
+    SampleFormat format,
+    std::mt19937_64 &rng,
+    FILE *obs_out,
+    SampleFormat obs_out_format,
+    size_t num_threads) {
+    if (prepend_observables + append_observables + (obs_out != nullptr) > 1) {
+        throw std::out_of_range("Can't combine --prepend_observables, --append_observables, or --obs_out");
+    }
+
+    // Each batch gets its own rng stream, so the results don't depend on thread scheduling.
+    uint64_t base_seed = rng();
+
+    // Keep a couple batches per thread in flight, so workers don't idle while results are written.
+    // Simulators are large, so don't make more than there are batches to fill them.
+    size_t num_batches = (num_shots + batch_size - 1) / batch_size;
+    num_threads = std::min(num_threads, num_batches);
+    size_t num_slots = std::min(2 * num_threads, num_batches);
+    std::vector<FrameSimulator<W>> slot_sims;
+    std::vector<size_t> slot_shots(num_slots, 0);
+    slot_sims.reserve(num_slots);
+    for (size_t k = 0; k < num_slots; k++) {
+        slot_sims.emplace_back(
+            circuit_stats, FrameSimulatorMode::STORE_DETECTIONS_TO_MEMORY, batch_size, std::mt19937_64(0));
+    }
+    simd_bit_table<W> out_concat_buf(0, 0);
+    if (append_observables || prepend_observables) {
+        out_concat_buf = simd_bit_table<W>(circuit_stats.num_detectors + circuit_stats.num_observables, batch_size);
+    }
+
+    size_t shots_assigned = 0;
+    run_ordered_pipeline(
+        num_threads,
+        num_slots,
+        [&](size_t batch_index, size_t slot) {
+            if (shots_assigned >= num_shots) {
+                return false;
+            }
+            slot_shots[slot] = std::min(num_shots - shots_assigned, batch_size);
+            shots_assigned += slot_shots[slot];
+            slot_sims[slot].rng = derived_rng_stream(base_seed, batch_index);
+            return true;
+        },
+        [&](size_t worker_index, size_t slot) {
+            slot_sims[slot].reset_all();
+            slot_sims[slot].do_circuit(circuit);
+        },
+        [&](size_t batch_index, size_t slot) {
+            write_frame_sim_dets_to_disk(
+                circuit_stats,
+                slot_sims[slot],
+                out_concat_buf,
+                slot_shots[slot],
+                prepend_observables,
+                append_observables,
+                out,
+                format,
+                obs_out,
+                obs_out_format);
+        });
+}
+
 template <size_t W>
 void rerun_frame_sim_in_memory_and_write_measurements_to_disk(
     const Circuit &circuit,
@@ -213,7 +310,8 @@ void sample_batch_detection_events_writing_results_to_disk(
     SampleFormat format,
     std::mt19937_64 &rng,
     FILE *obs_out,
-    SampleFormat obs_out_format) {
+    SampleFormat obs_out_format,
+    size_t num_threads) {
     if (num_shots == 0) {
         // Vacuously complete.
         return;
@@ -226,12 +324,29 @@ void sample_batch_detection_events_writing_results_to_disk(
     while (batch_size < 1024 && batch_size < num_shots) {
         batch_size += W;
     }
+
+    // There's no point in having more threads than batches. Batches only shrink from here, so
+    // this is a safe bound.
+    num_threads = std::max<size_t>(1, std::min(num_threads, (num_shots + batch_size - 1) / batch_size));
+
+    // With threads, there are two simulators per thread alive at once, sharing the memory budget.
     uint64_t memory_per_full_shot =
         2 * stats.num_qubits + 2 * stats.max_lookback + stats.num_observables + stats.num_detectors;
-    while (batch_size > 0 &&
-           should_use_streaming_because_bit_count_is_too_large_to_store(memory_per_full_shot * batch_size)) {
+    uint64_t num_simulators = num_threads > 1 ? 2 * num_threads : 1;
+    size_t max_batch_size = batch_size;
+    while (batch_size > 0 && should_use_streaming_because_bit_count_is_too_large_to_store(
+                                 memory_per_full_shot * batch_size * num_simulators)) {
         batch_size -= W;
     }
+    if (batch_size == 0 && num_threads > 1) {
+        // Too large for several simulators; fall back to a single one.
+        num_threads = 1;
+        batch_size = max_batch_size;
+        while (batch_size > 0 &&
+               should_use_streaming_because_bit_count_is_too_large_to_store(memory_per_full_shot * batch_size)) {
+            batch_size -= W;
+        }
+    }
 
     // If the batch size ended up at 0, the results won't fit in memory. Need to stream.
     bool streaming = batch_size == 0;
@@ -239,6 +354,24 @@ void sample_batch_detection_events_writing_results_to_disk(
         batch_size = W;
     }
 
+    // Streaming is only needed for circuits so large that there isn't memory to spare for extra simulators.
+    if (num_threads > 1 && !streaming) {
+        sample_dets_in_parallel_and_write_to_disk<W>(
+            circuit,
+            stats,
+            batch_size,
+            num_shots,
+            prepend_observables,
+            append_observables,
+            out,
+            format,
+            rng,
+            obs_out,
+            obs_out_format,
+            num_threads);
+        return;
+    }
+
     // Create a correctly sized frame simulator.
     FrameSimulator<W> frame_sim(
         stats,
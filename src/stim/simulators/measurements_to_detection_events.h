@@ -47,6 +47,10 @@ namespace stim {
 ///         all-zeroes instead of being collected from the circuit. This should probably only be done if you know the
 ///         all-zero sample is a valid sample, or if you know that the measurements were generated by a frame simulator
 ///         that was also incorrectly assuming an all-zero reference sample.
+///     obs_out: An optional file to write observable flip data to.
+///     obs_out_format: The format to use when writing observable flip data. Ignored when obs_out == nullptr.
+///     num_threads: The number of threads to convert batches of shots with. Reading and writing still happens on
+///         the calling thread, in order, overlapping with the conversion of other batches.
 template <size_t W>
 void stream_measurements_to_detection_events(
     FILE *measurements_in,
@@ -59,7 +63,8 @@ void stream_measurements_to_detection_events(
     bool append_observables,
     bool skip_reference_sample,
     FILE *obs_out,
-    SampleFormat obs_out_format);
+    SampleFormat obs_out_format,
+    size_t num_threads = 1);
 
 /// A variant of `stim::stream_measurements_to_detection_events` with derived values passed in, not recomputed.
 template <size_t W>
@@ -75,7 +80,8 @@ void stream_measurements_to_detection_events_helper(
     bool append_observables,
     simd_bits_range_ref<W> reference_sample,
     FILE *obs_out,
-    SampleFormat obs_out_format);
+    SampleFormat obs_out_format,
+    size_t num_threads = 1);
 
 /// Converts measurement data into detection event data based on a circuit.
 ///
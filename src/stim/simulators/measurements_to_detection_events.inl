@@ -19,10 +19,12 @@
 #include "stim/io/measure_record_reader.h"
 #include "stim/io/stim_data_formats.h"
 #include "stim/mem/simd_util.h"
+#include "stim/simulators/force_streaming.h"
 #include "stim/simulators/frame_simulator.h"
 #include "stim/simulators/measurements_to_detection_events.h"
 #include "stim/simulators/tableau_simulator.h"
 #include "stim/stabilizers/pauli_string.h"
+#include "stim/util_bot/ordered_pipeline.h"
 
 namespace stim {
 
@@ -168,7 +170,8 @@ void stream_measurements_to_detection_events(
     bool append_observables,
     bool skip_reference_sample,
     FILE *obs_out,
-    SampleFormat obs_out_format) {
+    SampleFormat obs_out_format,
+    size_t num_threads) {
     // Circuit metadata.
     CircuitStats circuit_stats = circuit.compute_stats();
     simd_bits<W> reference_sample(circuit_stats.num_measurements);
@@ -189,7 +192,8 @@ void stream_measurements_to_detection_events(
         append_observables,
         reference_sample,
         obs_out,
-        obs_out_format);
+        obs_out_format,
+        num_threads);
 }
 
 template <size_t W>
@@ -205,7 +209,8 @@ void stream_measurements_to_detection_events_helper(
     bool append_observables,
     simd_bits_range_ref<W> reference_sample,
     FILE *obs_out,
-    SampleFormat obs_out_format) {
+    SampleFormat obs_out_format,
+    size_t num_threads) {
     bool internally_append_observables = append_observables || obs_out != nullptr;
     size_t num_out_bits_including_any_obs =
         circuit_stats.num_detectors + circuit_stats.num_observables * internally_append_observables;
@@ -225,75 +230,114 @@ void stream_measurements_to_detection_events_helper(
             MeasureRecordReader<W>::make(optional_sweep_bits_in, sweep_bits_in_format, circuit_stats.num_sweep_bits);
     }
 
-    // Buffers and transposed buffers.
-    simd_bit_table<W> measurements__minor_shot_index(circuit_stats.num_measurements, num_buffered_shots);
-    simd_bit_table<W> out__minor_shot_index(num_out_bits_including_any_obs, num_buffered_shots);
-    simd_bit_table<W> out__major_shot_index(num_buffered_shots, num_out_bits_including_any_obs);
-    simd_bit_table<W> sweep_bits__minor_shot_index(num_sweep_bits_available, num_buffered_shots);
     if (reader->expects_empty_serialized_data_for_each_shot()) {
         throw std::invalid_argument(
             "Can't tell how many shots are in the measurement data.\n"
             "The circuit has no measurements and the measurement format encodes empty shots into no bytes.");
     }
 
-    // Data streaming loop.
+    // Buffers and transposed buffers, for each batch of shots that can be in flight at once.
+    struct Slot {
+        simd_bit_table<W> measurements__minor_shot_index;
+        simd_bit_table<W> sweep_bits__minor_shot_index;
+        simd_bit_table<W> out__minor_shot_index;
+        simd_bit_table<W> out__major_shot_index;
+        size_t record_count;
+    };
+    size_t bits_per_slot =
+        (circuit_stats.num_measurements + num_sweep_bits_available + 2 * num_out_bits_including_any_obs) *
+        num_buffered_shots;
+    size_t num_slots = num_threads > 1 ? 2 * num_threads : 1;
+    while (num_slots > 1 && should_use_streaming_because_bit_count_is_too_large_to_store(bits_per_slot * num_slots)) {
+        num_slots--;
+    }
+    num_threads = std::min(num_threads, num_slots);
+    std::vector<Slot> slots;
+    slots.reserve(num_slots);
+    for (size_t k = 0; k < num_slots; k++) {
+        slots.push_back(Slot{
+            simd_bit_table<W>(circuit_stats.num_measurements, num_buffered_shots),
+            simd_bit_table<W>(num_sweep_bits_available, num_buffered_shots),
+            simd_bit_table<W>(num_out_bits_including_any_obs, num_buffered_shots),
+            simd_bit_table<W>(num_buffered_shots, num_out_bits_including_any_obs),
+            0,
+        });
+    }
+
+    // Data streaming loop. Batches are read and written in order on this thread, while the conversion of each batch
+    // runs on the worker threads.
     size_t total_read = 0;
-    while (true) {
-        // Read measurement data and sweep data for a batch of shots.
-        size_t record_count = reader->read_records_into(measurements__minor_shot_index, false);
-        if (sweep_data_reader != nullptr) {
-            size_t sweep_data_count = sweep_data_reader->read_records_into(sweep_bits__minor_shot_index, false);
-            if (sweep_data_count != record_count && !sweep_data_reader->expects_empty_serialized_data_for_each_shot()) {
-                std::stringstream ss;
-                ss << "The sweep data contained a different number of shots than the measurement data.\n";
-                ss << "There was " << (record_count + total_read) << " shot records total.\n";
-                if (sweep_data_count < record_count) {
-                    ss << "But there was " << (record_count + sweep_data_count) << " sweep records total.";
-                } else {
-                    ss << "But there was at least " << (record_count + sweep_data_count) << " sweep records.";
+    run_ordered_pipeline(
+        num_threads,
+        num_slots,
+        [&](size_t task_index, size_t slot_index) {
+            Slot &slot = slots[slot_index];
+
+            // Read measurement data and sweep data for a batch of shots.
+            size_t record_count = reader->read_records_into(slot.measurements__minor_shot_index, false);
+            if (sweep_data_reader != nullptr) {
+                size_t sweep_data_count =
+                    sweep_data_reader->read_records_into(slot.sweep_bits__minor_shot_index, false);
+                if (sweep_data_count != record_count &&
+                    !sweep_data_reader->expects_empty_serialized_data_for_each_shot()) {
+                    std::stringstream ss;
+                    ss << "The sweep data contained a different number of shots than the measurement data.\n";
+                    ss << "There was " << (record_count + total_read) << " shot records total.\n";
+                    if (sweep_data_count < record_count) {
+                        ss << "But there was " << (record_count + sweep_data_count) << " sweep records total.";
+                    } else {
+                        ss << "But there was at least " << (record_count + sweep_data_count) << " sweep records.";
+                    }
+                    throw std::invalid_argument(ss.str());
                 }
-                throw std::invalid_argument(ss.str());
             }
-        }
-        if (record_count == 0) {
-            break;
-        }
-        total_read += record_count;
+            if (record_count == 0) {
+                return false;
+            }
+            total_read += record_count;
+            slot.record_count = record_count;
+            return true;
+        },
+        [&](size_t worker_index, size_t slot_index) {
+            Slot &slot = slots[slot_index];
 
-        // Convert measurement data into detection event data.
-        out__minor_shot_index.clear();
-        measurements_to_detection_events_helper<W>(
-            measurements__minor_shot_index,
-            sweep_bits__minor_shot_index,
-            out__minor_shot_index,
-            noiseless_circuit,
-            circuit_stats,
-            reference_sample,
-            internally_append_observables);
-        out__minor_shot_index.transpose_into(out__major_shot_index);
+            // Convert measurement data into detection event data.
+            slot.out__minor_shot_index.clear();
+            measurements_to_detection_events_helper<W>(
+                slot.measurements__minor_shot_index,
+                slot.sweep_bits__minor_shot_index,
+                slot.out__minor_shot_index,
+                noiseless_circuit,
+                circuit_stats,
+                reference_sample,
+                internally_append_observables);
+            slot.out__minor_shot_index.transpose_into(slot.out__major_shot_index);
+        },
+        [&](size_t task_index, size_t slot_index) {
+            Slot &slot = slots[slot_index];
 
-        // Write detection event data.
-        for (size_t k = 0; k < record_count; k++) {
-            simd_bits_range_ref<W> record = out__major_shot_index[k];
-            writer->begin_result_type('D');
-            writer->write_bits(record.u8, circuit_stats.num_detectors);
-            if (append_observables) {
-                writer->begin_result_type('L');
-                for (size_t k2 = 0; k2 < circuit_stats.num_observables; k2++) {
-                    writer->write_bit(record[circuit_stats.num_detectors + k2]);
+            // Write detection event data.
+            for (size_t k = 0; k < slot.record_count; k++) {
+                simd_bits_range_ref<W> record = slot.out__major_shot_index[k];
+                writer->begin_result_type('D');
+                writer->write_bits(record.u8, circuit_stats.num_detectors);
+                if (append_observables) {
+                    writer->begin_result_type('L');
+                    for (size_t k2 = 0; k2 < circuit_stats.num_observables; k2++) {
+                        writer->write_bit(record[circuit_stats.num_detectors + k2]);
+                    }
                 }
-            }
-            writer->write_end();
+                writer->write_end();
 
-            if (obs_out != nullptr) {
-                obs_writer->begin_result_type('L');
-                for (size_t k2 = 0; k2 < circuit_stats.num_observables; k2++) {
-                    obs_writer->write_bit(record[circuit_stats.num_detectors + k2]);
+                if (obs_out != nullptr) {
+                    obs_writer->begin_result_type('L');
+                    for (size_t k2 = 0; k2 < circuit_stats.num_observables; k2++) {
+                        obs_writer->write_bit(record[circuit_stats.num_detectors + k2]);
+                    }
+                    obs_writer->write_end();
                 }
-                obs_writer->write_end();
             }
-        }
-    }
+        });
 }
 
 }  // namespace stim
@@ -228,7 +228,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, empty_cases, {
         false,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), 0);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), std::max<size_t>(256, W));
 
     converted = measurements_to_detection_events(
         measurement_data,
@@ -240,7 +240,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, empty_cases, {
         false,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), 0);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), std::max<size_t>(256, W));
 })
 
 TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, big_shots, {
@@ -288,11 +288,11 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, big_data, {
         false,
         false);
     ASSERT_EQ(converted[0].popcnt(), 0);
-    ASSERT_EQ(converted[1].popcnt(), 256);
+    ASSERT_EQ(converted[1].popcnt(), std::max<size_t>(256, W));
     ASSERT_EQ(converted[2].popcnt(), 0);
-    ASSERT_EQ(converted[3].popcnt(), 256);
+    ASSERT_EQ(converted[3].popcnt(), std::max<size_t>(256, W));
     ASSERT_EQ(converted[398].popcnt(), 0);
-    ASSERT_EQ(converted[399].popcnt(), 256);
+    ASSERT_EQ(converted[399].popcnt(), std::max<size_t>(256, W));
     ASSERT_EQ(converted[400].popcnt(), 0);
     ASSERT_EQ(converted[401].popcnt(), 0);
 })
@@ -315,7 +315,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, append_observables, {
         true,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), min_bits);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), std::max<size_t>(256, W));
     ASSERT_EQ(converted[0][0], 0);
     ASSERT_EQ(converted[1][0], 0);
     ASSERT_EQ(converted[9][0], 1);
@@ -333,7 +333,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, append_observables, {
         true,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), min_bits);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), std::max<size_t>(256, W));
     ASSERT_EQ(converted[0][0], 1);
     ASSERT_EQ(converted[1][0], 1);
     ASSERT_EQ(converted[9][0], 0);
@@ -351,7 +351,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, append_observables, {
         false,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), 0);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), std::max<size_t>(256, W));
     converted = measurements_to_detection_events(
         measurement_data,
         sweep_data,
@@ -537,6 +537,106 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, many_shots, {
     ASSERT_EQ(rewind_read_close(out), expected);
 })
 
+TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, many_shots_multithreaded, {
+    // Enough shots for several batches, with sweep data and observables going to separate files.
+    auto rng = INDEPENDENT_TEST_RNG();
+    std::string measurements;
+    std::string sweeps;
+    std::string expected_dets;
+    std::string expected_obs;
+    for (size_t k = 0; k < 5000; k++) {
+        bool m0 = rng() & 1;
+        bool m1 = rng() & 1;
+        bool s0 = rng() & 1;
+        measurements += m0 ? '1' : '0';
+        measurements += m1 ? '1' : '0';
+        measurements += '\n';
+        sweeps += s0 ? "1\n" : "0\n";
+        expected_dets += "shot";
+        if (m0 ^ s0) {
+            expected_dets += " D0";
+        }
+        if (m0 ^ m1 ^ s0) {
+            expected_dets += " D1";
+        }
+        expected_dets += "\n";
+        expected_obs += m1 ? "1\n" : "0\n";
+    }
+    Circuit circuit(R"CIRCUIT(
+        CNOT sweep[0] 0
+        M 0 1
+        DETECTOR rec[-2]
+        DETECTOR rec[-1] rec[-2]
+        OBSERVABLE_INCLUDE(0) rec[-1]
+    )CIRCUIT");
+
+    for (size_t num_threads : std::vector<size_t>{1, 2, 5}) {
+        FILE *in = tmpfile();
+        fprintf(in, "%s", measurements.data());
+        rewind(in);
+        FILE *sweep_in = tmpfile();
+        fprintf(sweep_in, "%s", sweeps.data());
+        rewind(sweep_in);
+        FILE *out = tmpfile();
+        FILE *obs_out = tmpfile();
+        stream_measurements_to_detection_events<W>(
+            in,
+            SampleFormat::SAMPLE_FORMAT_01,
+            sweep_in,
+            SampleFormat::SAMPLE_FORMAT_01,
+            out,
+            SampleFormat::SAMPLE_FORMAT_DETS,
+            circuit,
+            false,
+            false,
+            obs_out,
+            SampleFormat::SAMPLE_FORMAT_01,
+            num_threads);
+        fclose(in);
+        fclose(sweep_in);
+        ASSERT_EQ(rewind_read_close(out), expected_dets) << num_threads;
+        ASSERT_EQ(rewind_read_close(obs_out), expected_obs) << num_threads;
+    }
+})
+
+TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, multithreaded_errors_are_propagated, {
+    FILE *in = tmpfile();
+    FILE *sweep_in = tmpfile();
+    for (size_t k = 0; k < 3000; k++) {
+        fprintf(in, "%s", "0\n");
+        if (k < 2500) {
+            fprintf(sweep_in, "%s", "0\n");
+        }
+    }
+    rewind(in);
+    rewind(sweep_in);
+    FILE *out = tmpfile();
+    ASSERT_THROW(
+        {
+            stream_measurements_to_detection_events<W>(
+                in,
+                SampleFormat::SAMPLE_FORMAT_01,
+                sweep_in,
+                SampleFormat::SAMPLE_FORMAT_01,
+                out,
+                SampleFormat::SAMPLE_FORMAT_01,
+                Circuit(R"CIRCUIT(
+                    CNOT sweep[0] 0
+                    M 0
+                    DETECTOR rec[-1]
+                )CIRCUIT"),
+                false,
+                false,
+                nullptr,
+                SampleFormat::SAMPLE_FORMAT_01,
+                4);
+        },
+        std::invalid_argument);
+    fclose(in);
+    fclose(sweep_in);
+    fclose(out);
+})
+
 TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, many_measurements_and_detectors, {
     FILE *in = tmpfile();
     std::string expected = "shot";
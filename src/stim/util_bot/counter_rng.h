@@ -0,0 +1,157 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_UTIL_BOT_COUNTER_RNG_H
+#define _STIM_UTIL_BOT_COUNTER_RNG_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace stim {
+
+/// Applies the Philox-4x32-10 block function to a counter, using the given key.
+///
+/// This is the counter-based generator from "Parallel Random Numbers: As Easy as 1, 2, 3"
+/// (Salmon et al, 2011). Each (counter, key) pair maps to 128 bits of output independently of
+/// every other pair, so any position of any stream can be computed directly.
+inline std::array<uint32_t, 4> philox4x32_10(std::array<uint32_t, 4> ctr, std::array<uint32_t, 2> key) {
+    constexpr uint64_t M0 = 0xD2511F53;
+    constexpr uint64_t M1 = 0xCD9E8D57;
+    constexpr uint32_t W0 = 0x9E3779B9;
+    constexpr uint32_t W1 = 0xBB67AE85;
+    for (size_t round = 0; round < 10; round++) {
+        uint64_t p0 = M0 * ctr[0];
+        uint64_t p1 = M1 * ctr[2];
+        ctr = {
+            (uint32_t)(p1 >> 32) ^ ctr[1] ^ key[0],
+            (uint32_t)p1,
+            (uint32_t)(p0 >> 32) ^ ctr[3] ^ key[1],
+            (uint32_t)p0,
+        };
+        key[0] += W0;
+        key[1] += W1;
+    }
+    return ctr;
+}
+
+/// A counter-based random number generator (Philox-4x32-10) producing 64 bit values.
+///
+/// Satisfies the UniformRandomBitGenerator requirements, so it can be used with the standard
+/// library's distributions. Unlike std::mt19937_64, there's no large hidden state to evolve: the
+/// k'th output of stream s under seed x is a pure function of (x, s, k). This makes it possible
+/// to jump to any stream in O(1), which parallel samplers use to give each batch of shots its own
+/// reproducible entropy, and to fill large buffers with independent blocks that the compiler can
+/// vectorize.
+struct CounterRng {
+    using result_type = uint64_t;
+
+    std::array<uint32_t, 2> key;
+    uint64_t stream;
+    /// Index of the next block of output to generate.
+    uint64_t block_index;
+    /// The second half of the most recently generated block, when it hasn't been returned yet.
+    uint64_t buffered;
+    bool has_buffered;
+
+    /// Creates a generator for the given stream of the given seed.
+    ///
+    /// Args:
+    ///     seed: Determines the key used by the block function.
+    ///     stream: Which of the 2^64 independent streams under the seed to produce.
+    explicit CounterRng(uint64_t seed = 0, uint64_t stream = 0)
+        : key{(uint32_t)seed, (uint32_t)(seed >> 32)},
+          stream(stream),
+          block_index(0),
+          buffered(0),
+          has_buffered(false) {
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+    static constexpr result_type max() {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+    /// Returns the two 64 bit outputs of the given block of this generator's stream.
+    inline std::array<uint64_t, 2> block(uint64_t index) const {
+        auto r = philox4x32_10({(uint32_t)index, (uint32_t)(index >> 32), (uint32_t)stream, (uint32_t)(stream >> 32)}, key);
+        return {(uint64_t)r[0] | ((uint64_t)r[1] << 32), (uint64_t)r[2] | ((uint64_t)r[3] << 32)};
+    }
+
+    inline result_type operator()() {
+        if (has_buffered) {
+            has_buffered = false;
+            return buffered;
+        }
+        auto b = block(block_index++);
+        buffered = b[1];
+        has_buffered = true;
+        return b[0];
+    }
+
+    /// Advances the generator as if it had been called n times, in O(1) time.
+    void discard(uint64_t n) {
+        if (n == 0) {
+            return;
+        }
+        if (has_buffered) {
+            has_buffered = false;
+            n--;
+        }
+        block_index += n >> 1;
+        if (n & 1) {
+            (*this)();
+        }
+    }
+
+    /// Overwrites the given range with the generator's next outputs.
+    ///
+    /// Produces the same values as calling the generator once per word, but the blocks are
+    /// computed independently of each other, in groups that the compiler can vectorize.
+    void fill(uint64_t *start, uint64_t *end) {
+        if (start != end && has_buffered) {
+            *start++ = (*this)();
+        }
+        constexpr size_t LANES = 4;
+        while (end - start >= (ptrdiff_t)(2 * LANES)) {
+            for (size_t k = 0; k < LANES; k++) {
+                auto b = block(block_index + k);
+                start[2 * k] = b[0];
+                start[2 * k + 1] = b[1];
+            }
+            block_index += LANES;
+            start += 2 * LANES;
+        }
+        while (start != end) {
+            *start++ = (*this)();
+        }
+    }
+
+    bool operator==(const CounterRng &other) const {
+        return key == other.key && stream == other.stream && block_index == other.block_index &&
+               has_buffered == other.has_buffered && (!has_buffered || buffered == other.buffered);
+    }
+    bool operator!=(const CounterRng &other) const {
+        return !(*this == other);
+    }
+};
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,121 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/util_bot/counter_rng.h"
+
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "stim/util_bot/probability_util.h"
+
+using namespace stim;
+
+TEST(counter_rng, philox4x32_10_known_answers) {
+    // Known answer vectors from the Random123 reference implementation.
+    ASSERT_EQ(
+        philox4x32_10({0, 0, 0, 0}, {0, 0}),
+        (std::array<uint32_t, 4>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    ASSERT_EQ(
+        philox4x32_10({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+        (std::array<uint32_t, 4>{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    ASSERT_EQ(
+        philox4x32_10({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+        (std::array<uint32_t, 4>{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(counter_rng, streams) {
+    CounterRng a(5, 0);
+    CounterRng b(5, 0);
+    CounterRng c(5, 1);
+    CounterRng d(6, 0);
+    auto x = a();
+    ASSERT_EQ(x, b());
+    ASSERT_NE(x, c());
+    ASSERT_NE(x, d());
+    ASSERT_NE(x, a());
+}
+
+TEST(counter_rng, fill_matches_sequential_calls) {
+    for (size_t skip = 0; skip < 3; skip++) {
+        for (size_t n = 0; n < 40; n++) {
+            CounterRng a(7, 3);
+            CounterRng b(7, 3);
+            for (size_t k = 0; k < skip; k++) {
+                a();
+                b();
+            }
+            std::vector<uint64_t> filled(n);
+            a.fill(filled.data(), filled.data() + n);
+            for (size_t k = 0; k < n; k++) {
+                ASSERT_EQ(filled[k], b()) << skip << ", " << n << ", " << k;
+            }
+            ASSERT_EQ(a, b);
+            ASSERT_EQ(a(), b());
+        }
+    }
+}
+
+TEST(counter_rng, discard) {
+    for (size_t skip = 0; skip < 3; skip++) {
+        for (size_t n = 0; n < 7; n++) {
+            CounterRng a(3, 9);
+            CounterRng b(3, 9);
+            for (size_t k = 0; k < skip; k++) {
+                a();
+                b();
+            }
+            a.discard(n);
+            for (size_t k = 0; k < n; k++) {
+                b();
+            }
+            ASSERT_EQ(a(), b());
+        }
+    }
+
+    // Jumping far ahead is cheap.
+    CounterRng a(3, 9);
+    a.discard(uint64_t{1} << 62);
+    ASSERT_EQ(a.block_index, uint64_t{1} << 61);
+}
+
+TEST(counter_rng, uniform_random_bit_generator) {
+    CounterRng rng(11);
+    std::uniform_int_distribution<int> dist(0, 9);
+    std::array<size_t, 10> counts{};
+    for (size_t k = 0; k < 100000; k++) {
+        counts[dist(rng)]++;
+    }
+    for (auto c : counts) {
+        ASSERT_GT(c, 9000);
+        ASSERT_LT(c, 11000);
+    }
+
+    size_t hits = 0;
+    RareErrorIterator::for_samples(0.01, 100000, rng, [&](size_t s) {
+        hits++;
+    });
+    ASSERT_GT(hits, 800);
+    ASSERT_LT(hits, 1200);
+
+    std::vector<uint64_t> data(1 << 14);
+    biased_randomize_bits(0.25, data.data(), data.data() + data.size(), rng);
+    size_t ones = 0;
+    for (auto w : data) {
+        ones += std::popcount(w);
+    }
+    double expected = data.size() * 64 * 0.25;
+    ASSERT_GT(ones, expected * 0.98);
+    ASSERT_LT(ones, expected * 1.02);
+}
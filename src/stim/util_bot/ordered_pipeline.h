@@ -0,0 +1,168 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_UTIL_BOT_ORDERED_PIPELINE_H
+#define _STIM_UTIL_BOT_ORDERED_PIPELINE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace stim {
+
+/// Runs a sequence of tasks through a prepare -> work -> finish pipeline.
+///
+/// The prepare and finish stages always run on the calling thread, in task order. The work
+/// stage runs concurrently on a pool of worker threads. This makes it possible to parallelize
+/// the expensive middle of a computation (e.g. simulating a batch of shots) while still reading
+/// inputs and writing outputs in a deterministic order.
+///
+/// Tasks are assigned to reusable slots (task k uses slot k % num_slots). A slot isn't reused
+/// until the task occupying it has been finished, which bounds how many tasks are in flight and
+/// lets callers keep large per-slot buffers alive across tasks.
+///
+/// Args:
+///     num_workers: The number of worker threads to use. When this is 0 or 1, no threads are
+///         spawned and each task is prepared, worked, and finished inline using slot 0.
+///     num_slots: The number of task slots. Ignored (treated as 1) when not using threads.
+///     prepare: A `bool(size_t task_index, size_t slot_index)` callback that fills the slot
+///         with the task's inputs. Returns false, instead of preparing a task, when there are
+///         no more tasks.
+///     work: A `void(size_t worker_index, size_t slot_index)` callback that does the work for
+///         the task occupying the slot. The worker index is in [0, max(num_workers, 1)), and
+///         each worker index is used by at most one thread at a time.
+///     finish: A `void(size_t task_index, size_t slot_index)` callback that consumes the
+///         results from the slot.
+///
+/// Raises:
+///     The first exception raised by any stage, after all workers have been stopped.
+template <typename PREPARE, typename WORK, typename FINISH>
+void run_ordered_pipeline(size_t num_workers, size_t num_slots, PREPARE prepare, WORK work, FINISH finish) {
+    if (num_workers <= 1) {
+        for (size_t k = 0; prepare(k, 0); k++) {
+            work(0, 0);
+            finish(k, 0);
+        }
+        return;
+    }
+    if (num_slots == 0) {
+        throw std::invalid_argument("num_slots == 0");
+    }
+
+    struct SharedState {
+        std::mutex mutex;
+        std::condition_variable work_available;
+        std::condition_variable work_completed;
+        std::deque<size_t> pending_slots;
+        std::vector<uint8_t> slot_completed;
+        std::exception_ptr failure;
+        bool stopping = false;
+        std::vector<std::thread> threads;
+
+        ~SharedState() {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            work_available.notify_all();
+            for (auto &t : threads) {
+                t.join();
+            }
+        }
+    } state;
+    state.slot_completed.resize(num_slots, 0);
+
+    for (size_t w = 0; w < num_workers; w++) {
+        state.threads.emplace_back([&state, &work, w]() {
+            while (true) {
+                size_t slot;
+                {
+                    std::unique_lock<std::mutex> lock(state.mutex);
+                    state.work_available.wait(lock, [&]() {
+                        return state.stopping || !state.pending_slots.empty();
+                    });
+                    if (state.stopping) {
+                        return;
+                    }
+                    slot = state.pending_slots.front();
+                    state.pending_slots.pop_front();
+                }
+
+                std::exception_ptr failure;
+                try {
+                    work(w, slot);
+                } catch (...) {
+                    failure = std::current_exception();
+                }
+
+                {
+                    std::unique_lock<std::mutex> lock(state.mutex);
+                    state.slot_completed[slot] = 1;
+                    if (failure != nullptr && state.failure == nullptr) {
+                        state.failure = failure;
+                    }
+                }
+                state.work_completed.notify_all();
+            }
+        });
+    }
+
+    size_t num_prepared = 0;
+    size_t num_finished = 0;
+    bool more_tasks = true;
+    while (true) {
+        while (more_tasks && num_prepared - num_finished < num_slots) {
+            size_t slot = num_prepared % num_slots;
+            if (!prepare(num_prepared, slot)) {
+                more_tasks = false;
+                break;
+            }
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.slot_completed[slot] = 0;
+                state.pending_slots.push_back(slot);
+            }
+            state.work_available.notify_one();
+            num_prepared++;
+        }
+        if (num_finished == num_prepared) {
+            break;
+        }
+
+        size_t slot = num_finished % num_slots;
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.work_completed.wait(lock, [&]() {
+                return state.slot_completed[slot] || state.failure != nullptr;
+            });
+            if (state.failure != nullptr) {
+                std::rethrow_exception(state.failure);
+            }
+        }
+        finish(num_finished, slot);
+        num_finished++;
+    }
+}
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,129 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/util_bot/ordered_pipeline.h"
+
+#include "gtest/gtest.h"
+
+using namespace stim;
+
+TEST(ordered_pipeline, preserves_task_order) {
+    for (size_t num_workers : {0, 1, 2, 3, 8}) {
+        for (size_t num_slots : {1, 2, 5}) {
+            std::vector<size_t> slot_inputs(num_slots);
+            std::vector<size_t> slot_outputs(num_slots);
+            std::vector<size_t> finished;
+            run_ordered_pipeline(
+                num_workers,
+                num_slots,
+                [&](size_t task, size_t slot) {
+                    if (task == 100) {
+                        return false;
+                    }
+                    slot_inputs[slot] = task;
+                    return true;
+                },
+                [&](size_t worker, size_t slot) {
+                    slot_outputs[slot] = slot_inputs[slot] * slot_inputs[slot];
+                },
+                [&](size_t task, size_t slot) {
+                    ASSERT_EQ(slot_outputs[slot], task * task);
+                    finished.push_back(task);
+                });
+            ASSERT_EQ(finished.size(), 100);
+            for (size_t k = 0; k < finished.size(); k++) {
+                ASSERT_EQ(finished[k], k);
+            }
+        }
+    }
+}
+
+TEST(ordered_pipeline, no_tasks) {
+    size_t calls = 0;
+    run_ordered_pipeline(
+        4,
+        4,
+        [&](size_t task, size_t slot) {
+            calls++;
+            return false;
+        },
+        [&](size_t worker, size_t slot) {
+            calls += 100;
+        },
+        [&](size_t task, size_t slot) {
+            calls += 100;
+        });
+    ASSERT_EQ(calls, 1);
+}
+
+TEST(ordered_pipeline, worker_indices_are_exclusive) {
+    std::vector<size_t> in_use(4);
+    std::vector<size_t> counts(4);
+    bool collision = false;
+    run_ordered_pipeline(
+        4,
+        8,
+        [&](size_t task, size_t slot) {
+            return task < 200;
+        },
+        [&](size_t worker, size_t slot) {
+            ASSERT_LT(worker, 4);
+            if (in_use[worker]++) {
+                collision = true;
+            }
+            counts[worker]++;
+            in_use[worker]--;
+        },
+        [&](size_t task, size_t slot) {
+        });
+    ASSERT_FALSE(collision);
+    ASSERT_EQ(counts[0] + counts[1] + counts[2] + counts[3], 200);
+}
+
+TEST(ordered_pipeline, propagates_exceptions) {
+    for (size_t num_workers : {1, 4}) {
+        ASSERT_THROW(
+            {
+                run_ordered_pipeline(
+                    num_workers,
+                    4,
+                    [&](size_t task, size_t slot) {
+                        return task < 50;
+                    },
+                    [&](size_t worker, size_t slot) {
+                        throw std::invalid_argument("work");
+                    },
+                    [&](size_t task, size_t slot) {
+                    });
+            },
+            std::invalid_argument);
+        ASSERT_THROW(
+            {
+                run_ordered_pipeline(
+                    num_workers,
+                    4,
+                    [&](size_t task, size_t slot) {
+                        return task < 50;
+                    },
+                    [&](size_t worker, size_t slot) {
+                    },
+                    [&](size_t task, size_t slot) {
+                        if (task == 7) {
+                            throw std::out_of_range("finish");
+                        }
+                    });
+            },
+            std::out_of_range);
+    }
+}
@@ -15,6 +15,7 @@
 #include "stim/util_bot/probability_util.h"
 
 #include <cstring>
+#include <type_traits>
 
 #include "stim/util_bot/arg_parse.h"
 
@@ -27,12 +28,6 @@ RareErrorIterator::RareErrorIterator(float probability)
     }
 }
 
-size_t RareErrorIterator::next(std::mt19937_64 &rng) {
-    size_t result = next_candidate + (is_one ? 0 : dist(rng));
-    next_candidate = result + 1;
-    return result;
-}
-
 std::vector<size_t> stim::sample_hit_indices(float probability, size_t attempts, std::mt19937_64 &rng) {
     std::vector<size_t> result;
     RareErrorIterator::for_samples(probability, attempts, rng, [&](size_t s) {
@@ -62,19 +57,35 @@ std::mt19937_64 stim::optionally_seeded_rng(int argc, const char **argv) {
     return std::mt19937_64(seed ^ INTENTIONAL_VERSION_SEED_INCOMPATIBILITY);
 }
 
-void stim::biased_randomize_bits(float probability, uint64_t *start, uint64_t *end, std::mt19937_64 &rng) {
+std::mt19937_64 stim::derived_rng_stream(uint64_t base_seed, uint64_t stream_index) {
+    std::seed_seq seq{
+        (uint32_t)base_seed,
+        (uint32_t)(base_seed >> 32),
+        (uint32_t)stream_index,
+        (uint32_t)(stream_index >> 32),
+        (uint32_t)INTENTIONAL_VERSION_SEED_INCOMPATIBILITY,
+    };
+    return std::mt19937_64(seq);
+}
+
+template <typename RNG>
+static void biased_randomize_bits_using(float probability, uint64_t *start, uint64_t *end, RNG &rng) {
     if (probability > 0.5) {
         // Recurse and invert for probabilities larger than 0.5.
-        biased_randomize_bits(1 - probability, start, end, rng);
+        biased_randomize_bits_using(1 - probability, start, end, rng);
         while (start != end) {
             *start ^= UINT64_MAX;
             start++;
         }
     } else if (probability == 0.5) {
         // For the 50/50 case, just copy the bits directly into the buffer.
-        while (start != end) {
-            *start = rng();
-            start++;
+        if constexpr (std::is_same_v<RNG, CounterRng>) {
+            rng.fill(start, end);
+        } else {
+            while (start != end) {
+                *start = rng();
+                start++;
+            }
         }
     } else if (probability < 0.02) {
         // For small probabilities, sample gaps using a geometric distribution.
@@ -121,3 +132,11 @@ void stim::biased_randomize_bits(float probability, uint64_t *start, uint64_t *e
         });
     }
 }
+
+void stim::biased_randomize_bits(float probability, uint64_t *start, uint64_t *end, std::mt19937_64 &rng) {
+    biased_randomize_bits_using(probability, start, end, rng);
+}
+
+void stim::biased_randomize_bits(float probability, uint64_t *start, uint64_t *end, CounterRng &rng) {
+    biased_randomize_bits_using(probability, start, end, rng);
+}
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "stim/mem/span_ref.h"
+#include "stim/util_bot/counter_rng.h"
 
 namespace stim {
 
@@ -30,15 +31,23 @@ constexpr uint64_t INTENTIONAL_VERSION_SEED_INCOMPATIBILITY = 0xDEADBEEF124CULL;
 
 /// Yields the indices of hits sampled from a Bernoulli distribution.
 /// Gets more efficient as the hit probability drops.
+///
+/// Works with any uniform random bit generator (e.g. std::mt19937_64 or CounterRng).
 struct RareErrorIterator {
     size_t next_candidate;
     bool is_one = false;
     std::geometric_distribution<size_t> dist;
     RareErrorIterator(float probability);
-    size_t next(std::mt19937_64 &rng);
 
-    template <typename BODY>
-    inline static void for_samples(double p, size_t n, std::mt19937_64 &rng, BODY body) {
+    template <typename RNG>
+    inline size_t next(RNG &rng) {
+        size_t result = next_candidate + (is_one ? 0 : dist(rng));
+        next_candidate = result + 1;
+        return result;
+    }
+
+    template <typename BODY, typename RNG>
+    inline static void for_samples(double p, size_t n, RNG &rng, BODY body) {
         if (p == 0) {
             return;
         }
@@ -52,8 +61,8 @@ struct RareErrorIterator {
         }
     }
 
-    template <typename BODY, typename T>
-    inline static void for_samples(double p, const SpanRef<const T> &vals, std::mt19937_64 &rng, BODY body) {
+    template <typename BODY, typename T, typename RNG>
+    inline static void for_samples(double p, const SpanRef<const T> &vals, RNG &rng, BODY body) {
         if (p == 0) {
             return;
         }
@@ -76,6 +85,16 @@ std::mt19937_64 externally_seeded_rng();
 /// Create a random number generator either seeded by a --seed argument, or else by entropy from the operating system.
 std::mt19937_64 optionally_seeded_rng(int argc, const char **argv);
 
+/// Create a random number generator for one of many independent streams derived from a base seed.
+///
+/// Parallel samplers use this to give each batch its own entropy, so that results depend on the
+/// batch index instead of on which thread happened to process the batch.
+///
+/// Args:
+///     base_seed: Seed shared by all the streams (typically drawn from a parent rng).
+///     stream_index: Which stream to create (typically the batch index).
+std::mt19937_64 derived_rng_stream(uint64_t base_seed, uint64_t stream_index);
+
 /// Overwrite the given span with random data where bits are set with the given probability.
 ///
 /// Args:
@@ -84,6 +103,7 @@ std::mt19937_64 optionally_seeded_rng(int argc, const char **argv);
 ///     end: Exclusive end of the memory span to overwrite.
 ///     rng: The random number generator to use to generate entropy.
 void biased_randomize_bits(float probability, uint64_t *start, uint64_t *end, std::mt19937_64 &rng);
+void biased_randomize_bits(float probability, uint64_t *start, uint64_t *end, CounterRng &rng);
 
 }  // namespace stim
 
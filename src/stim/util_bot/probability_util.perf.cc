@@ -102,3 +102,27 @@ BENCHMARK(biased_random_1024_99percent) {
         .goal_nanos(260)
         .show_rate("bits", n);
 }
+
+BENCHMARK(biased_random_1024_50percent_counter_rng) {
+    CounterRng rng(0);
+    float p = 0.5;
+    size_t n = 1024;
+    simd_bits<MAX_BITWORD_WIDTH> data(n);
+    benchmark_go([&]() {
+        biased_randomize_bits(p, data.u64, data.u64 + data.num_u64_padded(), rng);
+    })
+        .goal_nanos(40)
+        .show_rate("bits", n);
+}
+
+BENCHMARK(biased_random_1024_40percent_counter_rng) {
+    CounterRng rng(0);
+    float p = 0.4;
+    size_t n = 1024;
+    simd_bits<MAX_BITWORD_WIDTH> data(n);
+    benchmark_go([&]() {
+        biased_randomize_bits(p, data.u64, data.u64 + data.num_u64_padded(), rng);
+    })
+        .goal_nanos(420)
+        .show_rate("bits", n);
+}
@@ -68,3 +68,14 @@ TEST_EACH_WORD_SIZE_W(probability_util, biased_random, {
             << min_expected / n << " < " << t / (float)n << " < " << max_expected / n << " for p=" << p;
     }
 })
+
+TEST(probability_util, derived_rng_stream) {
+    auto a = derived_rng_stream(5, 0);
+    auto b = derived_rng_stream(5, 0);
+    auto c = derived_rng_stream(5, 1);
+    auto d = derived_rng_stream(6, 0);
+    auto x = a();
+    ASSERT_EQ(x, b());
+    ASSERT_NE(x, c());
+    ASSERT_NE(x, d());
+}